@@ -0,0 +1,97 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ClientConvertPool.hpp"
+#include <algorithm> //min
+
+//Channels are split into chunks of a multiple of this many elements,
+//so that every chunk except the last runs entirely in the SIMD loops.
+#define CONVERT_CHUNK_ALIGN_ELEMS 64
+
+ClientConvertPool::ClientConvertPool(const size_t numThreads):
+    _done(false),
+    _fcn(nullptr),
+    _scaleFactor(0.0),
+    _nextJob(0),
+    _jobsLeft(0)
+{
+    for (size_t i = 0; i < numThreads; i++)
+    {
+        _threads.push_back(new std::thread(&ClientConvertPool::workerLoop, this));
+    }
+}
+
+ClientConvertPool::~ClientConvertPool(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _workCond.notify_all();
+    for (auto thread : _threads)
+    {
+        thread->join();
+        delete thread;
+    }
+}
+
+void ClientConvertPool::convert(const ConvertFunction fcn, const double scaleFactor,
+    const void * const *in, const size_t inElemSize,
+    void * const *out, const size_t outElemSize,
+    const size_t numChans, const size_t numElems)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _fcn = fcn;
+    _scaleFactor = scaleFactor;
+    _jobs.clear();
+
+    //one job per channel when there are enough channels to go around,
+    //otherwise split each channel into enough chunks for every thread
+    const size_t numParts = _threads.size()+1;
+    const size_t chunksPerChan = (numChans >= numParts)?1:((numParts+numChans-1)/numChans);
+    size_t chunkElems = (numElems+chunksPerChan-1)/chunksPerChan;
+    chunkElems = ((chunkElems+CONVERT_CHUNK_ALIGN_ELEMS-1)/CONVERT_CHUNK_ALIGN_ELEMS)*CONVERT_CHUNK_ALIGN_ELEMS;
+
+    for (size_t i = 0; i < numChans; i++)
+    {
+        for (size_t offset = 0; offset < numElems; offset += chunkElems)
+        {
+            Job job;
+            job.in = (const char *)in[i] + offset*inElemSize;
+            job.out = (char *)out[i] + offset*outElemSize;
+            job.numElems = std::min(chunkElems, numElems-offset);
+            _jobs.push_back(job);
+        }
+    }
+    _nextJob = 0;
+    _jobsLeft = _jobs.size();
+    _workCond.notify_all();
+
+    //help out and wait for the workers to finish the remaining jobs
+    this->runJobs(lock);
+    while (_jobsLeft != 0) _doneCond.wait(lock);
+}
+
+void ClientConvertPool::runJobs(std::unique_lock<std::mutex> &lock)
+{
+    while (_nextJob < _jobs.size())
+    {
+        const Job job = _jobs[_nextJob++];
+        const auto fcn = _fcn;
+        const auto scaleFactor = _scaleFactor;
+        lock.unlock();
+        fcn(job.in, job.out, job.numElems, scaleFactor);
+        lock.lock();
+        if (--_jobsLeft == 0) _doneCond.notify_one();
+    }
+}
+
+void ClientConvertPool::workerLoop(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _done)
+    {
+        if (_nextJob < _jobs.size()) this->runJobs(lock);
+        else _workCond.wait(lock);
+    }
+}
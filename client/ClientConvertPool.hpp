@@ -0,0 +1,53 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyStreamConvert.hpp"
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/*!
+ * A pool of threads to convert wide multi-channel streams.
+ * Each call splits the conversion into jobs by channel,
+ * or into chunks of each channel when there are fewer channels than threads.
+ * The calling thread runs jobs as well and returns when all jobs are done.
+ */
+class ClientConvertPool
+{
+public:
+    //! Create the pool with the given number of worker threads
+    ClientConvertPool(const size_t numThreads);
+
+    ~ClientConvertPool(void);
+
+    //! Convert numElems elements on every channel from in to out
+    void convert(const ConvertFunction fcn, const double scaleFactor,
+        const void * const *in, const size_t inElemSize,
+        void * const *out, const size_t outElemSize,
+        const size_t numChans, const size_t numElems);
+
+private:
+    struct Job
+    {
+        const void *in;
+        void *out;
+        size_t numElems;
+    };
+
+    void workerLoop(void);
+    void runJobs(std::unique_lock<std::mutex> &lock);
+
+    bool _done;
+    std::mutex _mutex;
+    std::condition_variable _workCond; //signals new jobs
+    std::condition_variable _doneCond; //signals the last job finished
+    ConvertFunction _fcn;
+    double _scaleFactor;
+    std::vector<Job> _jobs;
+    size_t _nextJob;
+    size_t _jobsLeft;
+    std::vector<std::thread *> _threads;
+};
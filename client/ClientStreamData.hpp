@@ -3,26 +3,19 @@
 
 #pragma once
 #include "SoapyRPCSocket.hpp"
+#include "SoapyStreamConvert.hpp"
 #include <vector>
 #include <string>
 
 class SoapyStreamEndpoint;
-
-enum ConvertTypes
-{
-    CONVERT_MEMCPY,
-    CONVERT_CF32_CS16,
-    CONVERT_CF32_CS12,
-    CONVERT_CS16_CS12,
-    CONVERT_CS16_CS8,
-    CONVERT_CF32_CS8,
-    CONVERT_CF32_CU8,
-};
+class ClientConvertPool;
 
 struct ClientStreamData
 {
     ClientStreamData(void);
 
+    ~ClientStreamData(void);
+
     //string formats in use
     std::string localFormat;
     std::string remoteFormat;
@@ -49,7 +42,29 @@ struct ClientStreamData
 
     //converter implementations
     double scaleFactor;
-    ConvertTypes convertType;
+    const ConvertKernel *convertKernel; //null kernel functions for a plain copy
     void convertRecvBuffs(void * const *buffs, const size_t numElems);
     void convertSendBuffs(const void * const *buffs, const size_t numElems);
+
+    //optional conversion thread pool for wide streams
+    ClientConvertPool *convertPool;
+    size_t convertThreshold; //minimum samples per call across all channels
+    size_t localElemSize;
+
+    //conversion timing for calls in the calling thread and the pool
+    struct ConvertStats
+    {
+        ConvertStats(void);
+        size_t calls;
+        long long totalNs;
+    };
+    ConvertStats convertStats;
+    ConvertStats pooledStats;
+    void logConvertStats(void) const;
+
+private:
+    void convertBuffs(const ConvertFunction fcn,
+        const void * const *in, const size_t inElemSize,
+        void * const *out, const size_t outElemSize,
+        const size_t numChans, const size_t numElems);
 };
@@ -0,0 +1,43 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "CommandQueue.hpp"
+#include "SoapyRPCPacker.hpp"
+#include "SoapyRPCUnpacker.hpp"
+
+SoapyCommandQueue::SoapyCommandQueue(const std::string &url, const SoapySDR::Kwargs &args,
+    const SoapySDR::KwargsList &commands, const long timeoutUs, const long long periodNs):
+    _connection("SoapyCommandQueue", url, args,
+        [&commands, periodNs](SoapyRPCPacker &packer)
+        {
+            packer & ((periodNs == 0)?SOAPY_REMOTE_QUEUE_COMMANDS:SOAPY_REMOTE_REPEAT_COMMANDS);
+            packer & commands;
+            if (periodNs != 0) packer & periodNs;
+        },
+        SOAPY_REMOTE_CANCEL_COMMANDS,
+        [this](SoapyRPCUnpacker &unpacker){this->handleReport(unpacker);},
+        timeoutUs)
+{
+    return;
+}
+
+std::string SoapyCommandQueue::reports(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    SoapySDR::Kwargs reports;
+    for (const auto &pair : _reports) reports[std::to_string(pair.first)] = pair.second;
+    return SoapySDR::KwargsToString(reports);
+}
+
+void SoapyCommandQueue::handleReport(SoapyRPCUnpacker &unpacker)
+{
+    int index = 0;
+    long long timeNs = 0;
+    std::string errorMsg;
+    unpacker & index;
+    unpacker & timeNs;
+    unpacker & errorMsg;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (errorMsg.empty()) _reports[index] = std::to_string(timeNs);
+    else _reports[index] = "error: " + errorMsg;
+}
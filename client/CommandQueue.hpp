@@ -0,0 +1,34 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "PushConnection.hpp"
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <map>
+#include <mutex>
+
+/*!
+ * The command queue opens a push connection to the server,
+ * and uploads the timed commands for the same device there.
+ * The server executes the commands on the device hardware time,
+ * and repeats them with a period such as for a hopping table.
+ * The report of every executed command is pushed back.
+ * The commands that were not executed yet are cancelled on destruction.
+ */
+class SoapyCommandQueue
+{
+public:
+    SoapyCommandQueue(const std::string &url, const SoapySDR::Kwargs &args,
+        const SoapySDR::KwargsList &commands, const long timeoutUs, const long long periodNs = 0);
+
+    //! Get the last execution time in ns or error per command index as markup
+    std::string reports(void);
+
+private:
+    void handleReport(SoapyRPCUnpacker &unpacker);
+
+    std::mutex _mutex;
+    std::map<int, std::string> _reports;
+    SoapyPushConnection _connection; //last: the thread stops before the reports go away
+};
@@ -0,0 +1,96 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "PushConnection.hpp"
+#include "SoapyRPCPacker.hpp"
+#include "SoapyRPCUnpacker.hpp"
+#include <SoapySDR/Logger.hpp>
+#include <stdexcept>
+
+//timeout for the message polling loop before rechecking status
+#define PUSH_POLL_TIMEOUT_US 1500000
+
+SoapyPushConnection::SoapyPushConnection(const std::string &name, const std::string &url, const SoapySDR::Kwargs &args,
+    const StartCall &start, const SoapyRemoteCalls stopCall, const MessageHandler &handler, const long timeoutUs):
+    _name(name),
+    _url(url),
+    _stopCall(stopCall),
+    _handler(handler),
+    _done(true)
+{
+    int ret = _sock.connect(url, timeoutUs);
+    if (ret != 0)
+    {
+        throw std::runtime_error(name+"("+url+") -- connect FAIL: " + _sock.lastErrorMsg());
+    }
+
+    //the server hands out the same device for the same args
+    SoapyRPCPacker packerMake(_sock);
+    packerMake & SOAPY_REMOTE_MAKE;
+    packerMake & args;
+    packerMake();
+    SoapyRPCUnpacker unpackerMake(_sock);
+
+    SoapyRPCPacker packer(_sock);
+    start(packer);
+    packer();
+    SoapyRPCUnpacker unpacker(_sock);
+
+    _done = false;
+    _thread = std::thread(&SoapyPushConnection::handlerLoop, this);
+}
+
+SoapyPushConnection::~SoapyPushConnection(void)
+{
+    //cant throw in the destructor
+    //the connection is dropped when the thread exited on an error
+    if (not _done) try
+    {
+        //the thread exits on the reply to the stop
+        SoapyRPCPacker packerStop(_sock);
+        packerStop & _stopCall;
+        packerStop();
+        _thread.join();
+
+        //release device instance
+        SoapyRPCPacker packerUnmake(_sock);
+        packerUnmake & SOAPY_REMOTE_UNMAKE;
+        packerUnmake();
+        SoapyRPCUnpacker unpackerUnmake(_sock);
+
+        //graceful disconnect
+        SoapyRPCPacker packerHangup(_sock);
+        packerHangup & SOAPY_REMOTE_HANGUP;
+        packerHangup();
+        SoapyRPCUnpacker unpackerHangup(_sock);
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "~%s(%s) FAIL: %s", _name.c_str(), _url.c_str(), ex.what());
+    }
+
+    _done = true;
+    if (_thread.joinable()) _thread.join();
+    _sock.close();
+}
+
+void SoapyPushConnection::handlerLoop(void)
+{
+    try
+    {
+        //loop while active to handle the pushed messages
+        while (not _done)
+        {
+            if (not _sock.selectRecv(PUSH_POLL_TIMEOUT_US)) continue;
+            SoapyRPCUnpacker unpacker(_sock, true, -1/*no timeout*/);
+            if (unpacker.done()) break; //got stop reply
+            _handler(unpacker);
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "%s::handlerLoop(%s) FAIL: %s", _name.c_str(), _url.c_str(), ex.what());
+    }
+
+    _done = true;
+}
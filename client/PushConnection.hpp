@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRPCSocket.hpp"
+#include "SoapyRemoteDefs.hpp"
+#include <SoapySDR/Types.hpp>
+#include <csignal> //sig_atomic_t
+#include <functional>
+#include <string>
+#include <thread>
+
+class SoapyRPCPacker;
+class SoapyRPCUnpacker;
+
+/*!
+ * The push connection opens a second connection to the server,
+ * makes the same device there, and sends a start call.
+ * A thread hands every message that the server pushes to the handler
+ * until the stop call is replied to in the destructor.
+ */
+class SoapyPushConnection
+{
+public:
+    //! Pack the start call and its arguments
+    typedef std::function<void(SoapyRPCPacker &)> StartCall;
+
+    //! Unpack one pushed message, called on the connection thread
+    typedef std::function<void(SoapyRPCUnpacker &)> MessageHandler;
+
+    /*!
+     * Connect, make the device, send the start call, and start the thread.
+     * The name of the owner class is used in the error messages.
+     */
+    SoapyPushConnection(const std::string &name, const std::string &url, const SoapySDR::Kwargs &args,
+        const StartCall &start, const SoapyRemoteCalls stopCall, const MessageHandler &handler, const long timeoutUs);
+
+    //! Send the stop call, release the device, and disconnect
+    ~SoapyPushConnection(void);
+
+    //! False once the thread exited on an error
+    bool active(void) const
+    {
+        return not _done;
+    }
+
+private:
+    void handlerLoop(void);
+
+    SoapyRPCSocket _sock;
+    const std::string _name;
+    const std::string _url;
+    const SoapyRemoteCalls _stopCall;
+    const MessageHandler _handler;
+    sig_atomic_t _done;
+    std::thread _thread;
+};
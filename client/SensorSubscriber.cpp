@@ -0,0 +1,49 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SensorSubscriber.hpp"
+#include "SoapyRPCPacker.hpp"
+#include "SoapyRPCUnpacker.hpp"
+
+SoapySensorSubscriber::SoapySensorSubscriber(const std::string &url, const SoapySDR::Kwargs &args,
+    const SoapySDR::KwargsList &subscriptions, const long timeoutUs):
+    _connection("SoapySensorSubscriber", url, args,
+        [&subscriptions](SoapyRPCPacker &packer)
+        {
+            packer & SOAPY_REMOTE_SUBSCRIBE_SENSORS;
+            packer & subscriptions;
+        },
+        SOAPY_REMOTE_UNSUBSCRIBE_SENSORS,
+        [this](SoapyRPCUnpacker &unpacker){this->handleUpdates(unpacker);},
+        timeoutUs)
+{
+    return;
+}
+
+bool SoapySensorSubscriber::read(const int direction, const size_t channel, const std::string &name, std::string &value)
+{
+    //stale values are not used, reads go back to the device socket
+    if (not _connection.active()) return false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _values.find(std::make_tuple(direction, int(channel), name));
+    if (it == _values.end()) return false;
+    value = it->second;
+    return true;
+}
+
+void SoapySensorSubscriber::handleUpdates(SoapyRPCUnpacker &unpacker)
+{
+    while (not unpacker.done())
+    {
+        char direction = 0;
+        int channel = 0;
+        std::string name, value;
+        unpacker & direction;
+        unpacker & channel;
+        unpacker & name;
+        unpacker & value;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _values[std::make_tuple(int(direction), channel, name)] = value;
+    }
+}
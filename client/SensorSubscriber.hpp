@@ -0,0 +1,33 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "PushConnection.hpp"
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <tuple>
+#include <map>
+#include <mutex>
+
+/*!
+ * The sensor subscriber opens a push connection to the server,
+ * and subscribes to the sensors of the same device there.
+ * The pushed updates are received into a local cache,
+ * so that readSensor() does not need a call on the device socket.
+ */
+class SoapySensorSubscriber
+{
+public:
+    SoapySensorSubscriber(const std::string &url, const SoapySDR::Kwargs &args,
+        const SoapySDR::KwargsList &subscriptions, const long timeoutUs);
+
+    //! Get the last pushed value of a sensor, direction -1 for device sensors
+    bool read(const int direction, const size_t channel, const std::string &name, std::string &value);
+
+private:
+    void handleUpdates(SoapyRPCUnpacker &unpacker);
+
+    std::mutex _mutex;
+    std::map<std::tuple<int, int, std::string>, std::string> _values;
+    SoapyPushConnection _connection; //last: the thread stops before the values go away
+};
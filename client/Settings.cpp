@@ -4,11 +4,16 @@
 
 #include "SoapyClient.hpp"
 #include "LogAcceptor.hpp"
+#include "SensorSubscriber.hpp"
+#include "CommandQueue.hpp"
+#include "SweepReceiver.hpp"
 #include "SoapyRemoteDefs.hpp"
 #include "SoapyRPCPacker.hpp"
 #include "SoapyRPCUnpacker.hpp"
 #include <SoapySDR/Logger.hpp>
 #include <stdexcept>
+#include <sstream>
+#include <cstring> //memcpy
 
 /*******************************************************************
  * Constructor
@@ -16,12 +21,28 @@
 
 SoapyRemoteDevice::SoapyRemoteDevice(const std::string &url, const SoapySDR::Kwargs &args):
     _logAcceptor(nullptr),
-    _defaultStreamProt("udp")
+    _defaultStreamProt("udp"),
+    _remoteRPCVersion(0),
+    _pipeline(false),
+    _nextRequestId(0),
+    _batch(nullptr),
+    _batchCalls(0),
+    _batchClearsCache(false),
+    _cache(true),
+    _shadow(false),
+    _url(url),
+    _args(args),
+    _timeoutUs(SOAPY_REMOTE_SOCKET_TIMEOUT_US),
+    _sensorSubscriber(nullptr),
+    _commandQueue(nullptr),
+    _hopTable(nullptr),
+    _sweepReceiver(nullptr)
 {
     //extract timeout
     long timeoutUs = SOAPY_REMOTE_SOCKET_TIMEOUT_US;
     const auto timeoutIt = args.find("timeout");
     if (timeoutIt != args.end()) timeoutUs = std::stol(timeoutIt->second);
+    _timeoutUs = timeoutUs;
 
     //try to connect to the remote server
     int ret = _sock.connect(url, timeoutUs);
@@ -39,14 +60,46 @@ SoapyRemoteDevice::SoapyRemoteDevice(const std::string &url, const SoapySDR::Kwa
     packer & args;
     packer();
     SoapyRPCUnpacker unpacker(_sock);
+    _remoteRPCVersion = unpacker.remoteRPCVersion();
 
     //default stream protocol specified in device args
     const auto protIt = args.find("prot");
     if (protIt != args.end()) _defaultStreamProt = protIt->second;
+
+    //pipeline the setter calls when specified in device args
+    const auto pipelineIt = args.find("pipeline");
+    _pipeline = (pipelineIt != args.end() and pipelineIt->second == "true");
+    if (_pipeline and _remoteRPCVersion < SoapyRPCVersionPipeline)
+    {
+        SoapySDR::log(SOAPY_SDR_WARNING, "SoapyRemoteDevice() -- server does not support pipeline, calls will wait");
+        _pipeline = false;
+    }
+
+    //shadow the written settings when specified in device args
+    const auto shadowIt = args.find("shadow");
+    _shadow = (shadowIt != args.end() and shadowIt->second == "true");
+
+    //cache the properties that do not change unless disabled in device args
+    const auto cacheIt = args.find("cache");
+    _cache = (cacheIt == args.end() or cacheIt->second != "false");
+    if (_cache and _remoteRPCVersion >= SoapyRPCVersionBatch) try
+    {
+        this->prefetchCache();
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_DEBUG, "SoapyRemoteDevice() -- prefetch cache FAIL: %s", ex.what());
+    }
 }
 
 SoapyRemoteDevice::~SoapyRemoteDevice(void)
 {
+    //end the sensor subscription, command queue, hopping, and sweep on their own connections
+    delete _sensorSubscriber;
+    delete _commandQueue;
+    delete _hopTable;
+    delete _sweepReceiver;
+
     //cant throw in the destructor
     try
     {
@@ -67,10 +120,613 @@ SoapyRemoteDevice::~SoapyRemoteDevice(void)
         SoapySDR::logf(SOAPY_SDR_ERROR, "~SoapyRemoteDevice() FAIL: %s", ex.what());
     }
 
+    //an unfinished batch is dropped
+    delete _batch;
+
     //disconnect the log acceptor (does not throw)
     delete _logAcceptor;
 }
 
+/*******************************************************************
+ * Pipelined calls:
+ * A pipelined setter does not wait for its reply,
+ * so many setters can be in flight on the connection.
+ * The server handles the calls of a connection in order,
+ * any call that waits for its reply collects the replies
+ * of the pipelined calls before it and throws the first error,
+ * and the setters collect the replies that already arrived.
+ *
+ * Batched calls:
+ * Between writeSetting("remote:batch", "true") and "false",
+ * the setters are held by the client and sent as one call.
+ * The getters are not batched and see the settings before the batch.
+ ******************************************************************/
+
+void SoapyRemoteDevice::packPipelined(SoapyRPCPacker &packer, const ShadowKey *shadowKey)
+{
+    this->clearShadow(shadowKey);
+    if (_pipeline and _batch == nullptr) packer.packRequestId(_nextRequestId++);
+}
+
+void SoapyRemoteDevice::sendPipelined(SoapyRPCPacker &packer)
+{
+    if (_batch != nullptr)
+    {
+        _batch->packCalls(packer);
+        _batchCalls++;
+        return;
+    }
+
+    packer();
+
+    if (not _pipeline)
+    {
+        SoapyRPCUnpacker unpacker(_sock);
+        return;
+    }
+
+    //collect the replies that already arrived without waiting
+    while (_sock.selectRecv(0))
+    {
+        SoapyRPCUnpacker unpacker(_sock, false, -1);
+        unpacker.recvReply();
+    }
+}
+
+void SoapyRemoteDevice::sendBatch(const SoapyRPCPacker &calls, const int numCalls) const
+{
+    SoapyRPCPacker packer(_sock);
+    packer & SOAPY_REMOTE_BATCH;
+    packer & numCalls;
+    packer.packCalls(calls);
+    packer();
+}
+
+void SoapyRemoteDevice::beginBatch(void)
+{
+    if (_remoteRPCVersion < SoapyRPCVersionBatch)
+    {
+        SoapySDR::log(SOAPY_SDR_WARNING, "SoapyRemoteDevice::beginBatch() -- server does not support batch, calls will not be batched");
+        return;
+    }
+    if (_batch == nullptr) _batch = new SoapyRPCPacker(_sock);
+}
+
+void SoapyRemoteDevice::endBatch(void)
+{
+    if (_batch == nullptr) return;
+    SoapyRPCPacker *batch = _batch;
+    const int numCalls = _batchCalls;
+    _batch = nullptr;
+    _batchCalls = 0;
+    if (numCalls == 0)
+    {
+        delete batch;
+        return;
+    }
+
+    this->sendBatch(*batch, numCalls);
+    delete batch;
+    if (_batchClearsCache) this->clearCache();
+    _batchClearsCache = false;
+
+    //the results end at the first error of the batch,
+    //an error of the pipelined calls before drops the results
+    try
+    {
+        SoapyRPCUnpacker unpacker(_sock);
+        while (not unpacker.done())
+        {
+            SoapyRemoteTypes type;
+            unpacker & type;
+            if (type != SOAPY_REMOTE_EXCEPTION) continue;
+            std::string errorMsg;
+            unpacker & errorMsg;
+            throw std::runtime_error("RemoteError: "+errorMsg);
+        }
+    }
+    catch (const std::exception &)
+    {
+        this->clearShadow(nullptr);
+        throw;
+    }
+}
+
+/*******************************************************************
+ * Property cache:
+ * Ranges, lists and setting infos do not change after make.
+ * They are prefetched in batched calls at construction,
+ * and the other channels and calls are cached on first use.
+ * The calls that can change them clear the cache.
+ ******************************************************************/
+
+template <typename Map>
+static bool unpackCached(SoapyRPCUnpacker &unpacker, Map &cache, const typename Map::key_type &key)
+{
+    //the first error ends the batch, the rest is cached on first use
+    if (unpacker.peekType() == SOAPY_REMOTE_EXCEPTION)
+    {
+        unpacker.discard();
+        return false;
+    }
+    unpacker & cache[key];
+    return true;
+}
+
+void SoapyRemoteDevice::prefetchCache(void)
+{
+    static const int directions[] = {SOAPY_SDR_TX, SOAPY_SDR_RX};
+    static const SoapyRemoteCalls channelCalls[] = {
+        SOAPY_REMOTE_LIST_ANTENNAS,
+        SOAPY_REMOTE_GET_GAIN_RANGE,
+        SOAPY_REMOTE_GET_FREQUENCY_RANGE,
+        SOAPY_REMOTE_LIST_SAMPLE_RATES,
+        SOAPY_REMOTE_GET_STREAM_FORMATS,
+        SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO,
+    };
+
+    //the channel counts and the device settings
+    SoapyRPCPacker deviceCalls(_sock);
+    for (const int dir : directions)
+    {
+        deviceCalls & SOAPY_REMOTE_GET_NUM_CHANNELS;
+        deviceCalls & char(dir);
+    }
+    deviceCalls & SOAPY_REMOTE_GET_SETTING_INFO;
+    this->sendBatch(deviceCalls, 3);
+
+    SoapyRPCUnpacker deviceUnpacker(_sock);
+    int numChans[2] = {0, 0};
+    deviceUnpacker & numChans[0];
+    deviceUnpacker & numChans[1];
+    if (not unpackCached(deviceUnpacker, _cachedArgInfo, CacheKey(SOAPY_REMOTE_GET_SETTING_INFO, 0, 0))) return;
+
+    //the properties of every channel
+    SoapyRPCPacker calls(_sock);
+    int numCalls = 0;
+    for (size_t i = 0; i < 2; i++)
+    {
+        for (int ch = 0; ch < numChans[i]; ch++)
+        {
+            for (const auto call : channelCalls)
+            {
+                calls & call;
+                calls & char(directions[i]);
+                calls & ch;
+                numCalls++;
+            }
+        }
+    }
+    if (numCalls == 0) return;
+    this->sendBatch(calls, numCalls);
+
+    SoapyRPCUnpacker unpacker(_sock);
+    for (size_t i = 0; i < 2; i++)
+    {
+        for (int ch = 0; ch < numChans[i]; ch++)
+        {
+            const int dir = directions[i];
+            if (not unpackCached(unpacker, _cachedStrings, CacheKey(SOAPY_REMOTE_LIST_ANTENNAS, dir, ch))) return;
+            if (not unpackCached(unpacker, _cachedRange, CacheKey(SOAPY_REMOTE_GET_GAIN_RANGE, dir, ch))) return;
+            if (not unpackCached(unpacker, _cachedRangeList, CacheKey(SOAPY_REMOTE_GET_FREQUENCY_RANGE, dir, ch))) return;
+            if (not unpackCached(unpacker, _cachedDoubles, CacheKey(SOAPY_REMOTE_LIST_SAMPLE_RATES, dir, ch))) return;
+            if (not unpackCached(unpacker, _cachedStrings, CacheKey(SOAPY_REMOTE_GET_STREAM_FORMATS, dir, ch))) return;
+            if (not unpackCached(unpacker, _cachedArgInfo, CacheKey(SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO, dir, ch))) return;
+        }
+    }
+}
+
+void SoapyRemoteDevice::clearCache(void)
+{
+    //a held batch clears the cache again once it was sent
+    if (_batch != nullptr) _batchClearsCache = true;
+    _cachedStrings.clear();
+    _cachedRange.clear();
+    _cachedRangeList.clear();
+    _cachedDoubles.clear();
+    _cachedArgInfo.clear();
+}
+
+/*******************************************************************
+ * Settings shadow:
+ * With remote:shadow=true, the client keeps the last value written
+ * to each gain, frequency, and setting, and identical writes return
+ * without a call. The value read back after a write is kept until
+ * the next write, except for gains which automatic gain control
+ * changes on the device. Writing a gain or frequency clears the other
+ * components of the channel, and the setters that are not shadowed
+ * clear the whole shadow. Settings that are not listed in the setting
+ * infos are volatile. Pipelined writes are not shadowed,
+ * because their errors are only logged.
+ ******************************************************************/
+
+static std::string shadowValue(const double value)
+{
+    return std::string((const char *)&value, sizeof(value));
+}
+
+static double shadowDouble(const std::string &shadow)
+{
+    double value = 0.0;
+    std::memcpy(&value, shadow.data(), sizeof(value));
+    return value;
+}
+
+bool SoapyRemoteDevice::isShadowed(const ShadowKey &shadowKey) const
+{
+    if (not _shadow) return false;
+    const int call = std::get<0>(shadowKey);
+    if (call != SOAPY_REMOTE_WRITE_SETTING and call != SOAPY_REMOTE_WRITE_CHANNEL_SETTING) return true;
+
+    const CacheKey infoKey = (call == SOAPY_REMOTE_WRITE_SETTING)?
+        CacheKey(SOAPY_REMOTE_GET_SETTING_INFO, 0, 0):
+        CacheKey(SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO, std::get<1>(shadowKey), std::get<2>(shadowKey));
+    const auto it = _cachedArgInfo.find(infoKey);
+    if (it == _cachedArgInfo.end()) return false;
+    for (const auto &info : it->second)
+    {
+        if (info.key == std::get<3>(shadowKey)) return true;
+    }
+    return false;
+}
+
+bool SoapyRemoteDevice::isRedundantWrite(const ShadowKey &shadowKey, const std::string &shadow) const
+{
+    const auto it = _shadowWrites.find(shadowKey);
+    return it != _shadowWrites.end() and it->second == shadow;
+}
+
+void SoapyRemoteDevice::recordWrite(const ShadowKey &shadowKey, const std::string &shadow)
+{
+    if (_pipeline and _batch == nullptr) return;
+    if (this->isShadowed(shadowKey)) _shadowWrites[shadowKey] = shadow;
+}
+
+bool SoapyRemoteDevice::findRead(const ShadowKey &shadowKey, std::string &shadow) const
+{
+    const auto it = _shadowReads.find(shadowKey);
+    if (it == _shadowReads.end()) return false;
+    shadow = it->second;
+    return true;
+}
+
+void SoapyRemoteDevice::recordRead(const ShadowKey &shadowKey, const std::string &shadow) const
+{
+    //a read during a batch comes before the held writes
+    if (_batch != nullptr or std::get<0>(shadowKey) == SOAPY_REMOTE_SET_GAIN) return;
+    if (_shadowWrites.count(shadowKey) != 0) _shadowReads[shadowKey] = shadow;
+}
+
+void SoapyRemoteDevice::clearShadow(const ShadowKey *shadowKey)
+{
+    if (shadowKey == nullptr or not this->isShadowed(*shadowKey))
+    {
+        _shadowWrites.clear();
+        _shadowReads.clear();
+        return;
+    }
+
+    //a setting only changes itself
+    const int call = std::get<0>(*shadowKey);
+    if (call == SOAPY_REMOTE_WRITE_SETTING or call == SOAPY_REMOTE_WRITE_CHANNEL_SETTING)
+    {
+        _shadowWrites.erase(*shadowKey);
+        _shadowReads.erase(*shadowKey);
+        return;
+    }
+
+    //the components of a gain or frequency change together
+    const ShadowKey first(call, std::get<1>(*shadowKey), std::get<2>(*shadowKey), "");
+    for (auto shadows : {&_shadowWrites, &_shadowReads})
+    {
+        auto it = shadows->lower_bound(first);
+        while (it != shadows->end() and std::get<0>(it->first) == call and
+            std::get<1>(it->first) == std::get<1>(first) and std::get<2>(it->first) == std::get<2>(first))
+        {
+            it = shadows->erase(it);
+        }
+    }
+}
+
+/*******************************************************************
+ * Sensor subscription:
+ * The subscribed sensors are sampled on the server and pushed over
+ * a second connection, so that reading them does not need a call
+ * and does not wait behind the other calls on the device socket.
+ ******************************************************************/
+
+static SoapySDR::KwargsList parseSensorSubscriptions(const std::string &spec)
+{
+    SoapySDR::KwargsList subscriptions;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ','))
+    {
+        entry.erase(0, entry.find_first_not_of(" \t"));
+        entry.erase(entry.find_last_not_of(" \t")+1);
+        if (entry.empty()) continue;
+
+        SoapySDR::Kwargs sub;
+        sub["direction"] = "-1";
+        sub["channel"] = "0";
+        sub["period_us"] = "1000000";
+        sub["on_change"] = "false";
+
+        //optional rx<N>/ or tx<N>/ for a channel sensor
+        const auto slash = entry.find('/');
+        if (slash != std::string::npos)
+        {
+            const std::string dir = entry.substr(0, 2);
+            if (dir == "rx" or dir == "RX") sub["direction"] = std::to_string(SOAPY_SDR_RX);
+            else if (dir == "tx" or dir == "TX") sub["direction"] = std::to_string(SOAPY_SDR_TX);
+            else throw std::runtime_error("SoapyRemote::subscribeSensors() bad direction in "+entry);
+            sub["channel"] = std::to_string(std::stoul(entry.substr(2, slash-2)));
+            entry = entry.substr(slash+1);
+        }
+
+        //name with the optional period and change policy
+        std::stringstream fields(entry);
+        std::string field;
+        std::getline(fields, field, ':');
+        sub["name"] = field;
+        while (std::getline(fields, field, ':'))
+        {
+            if (field == "change") sub["on_change"] = "true";
+            else sub["period_us"] = std::to_string(std::stol(field)*1000);
+        }
+        subscriptions.push_back(sub);
+    }
+    return subscriptions;
+}
+
+void SoapyRemoteDevice::subscribeSensors(const std::string &spec)
+{
+    const auto subscriptions = parseSensorSubscriptions(spec);
+    if (not subscriptions.empty() and _remoteRPCVersion < SoapyRPCVersionSensors)
+    {
+        throw std::runtime_error("SoapyRemote::subscribeSensors() server does not support remote:sensors");
+    }
+
+    std::lock_guard<std::mutex> lock(_sensorMutex);
+    delete _sensorSubscriber;
+    _sensorSubscriber = nullptr;
+    if (subscriptions.empty()) return;
+    _sensorSubscriber = new SoapySensorSubscriber(_url, _args, subscriptions, _timeoutUs);
+}
+
+bool SoapyRemoteDevice::readSubscribedSensor(const int direction, const size_t channel, const std::string &name, std::string &value) const
+{
+    std::lock_guard<std::mutex> lock(_sensorMutex);
+    if (_sensorSubscriber == nullptr) return false;
+    return _sensorSubscriber->read(direction, channel, name, value);
+}
+
+/*******************************************************************
+ * Command queue:
+ * The queued commands wait on the server for the hardware time,
+ * so that their timing does not depend on the network latency.
+ * The reports are pushed back over a second connection.
+ ******************************************************************/
+
+static SoapySDR::KwargsList parseQueuedCommands(const std::string &spec)
+{
+    SoapySDR::KwargsList commands;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ';'))
+    {
+        auto command = SoapySDR::KwargsFromString(entry);
+        if (command.empty()) continue;
+        if (command.count("time") == 0 or command.count("call") == 0)
+        {
+            throw std::runtime_error("SoapyRemote::queueCommands() missing time or call in "+entry);
+        }
+
+        //the server takes the direction as a number
+        const auto dirIt = command.find("direction");
+        if (dirIt != command.end())
+        {
+            if (dirIt->second == "rx" or dirIt->second == "RX") dirIt->second = std::to_string(SOAPY_SDR_RX);
+            else if (dirIt->second == "tx" or dirIt->second == "TX") dirIt->second = std::to_string(SOAPY_SDR_TX);
+        }
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+void SoapyRemoteDevice::queueCommands(const std::string &spec)
+{
+    const auto commands = parseQueuedCommands(spec);
+    if (not commands.empty() and _remoteRPCVersion < SoapyRPCVersionCommandQueue)
+    {
+        throw std::runtime_error("SoapyRemote::queueCommands() server does not support remote:queue");
+    }
+
+    delete _commandQueue;
+    _commandQueue = nullptr;
+    if (commands.empty()) return;
+    _commandQueue = new SoapyCommandQueue(_url, _args, commands, _timeoutUs);
+}
+
+/*******************************************************************
+ * Frequency hopping:
+ * The hopping table is turned into repeating timed commands,
+ * so that the hop rate is limited by the device and not the network.
+ * The commands of a hop share its index, so that the reports
+ * give the hardware time of the last boundary of every hop.
+ ******************************************************************/
+
+static SoapySDR::KwargsList parseHoppingTable(const std::string &spec, SoapySDR::Kwargs &options, long long &periodNs)
+{
+    SoapySDR::KwargsList hops;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ';'))
+    {
+        const auto hop = SoapySDR::KwargsFromString(entry);
+        if (hop.empty()) continue;
+        if (hop.count("freq") == 0)
+        {
+            for (const auto &pair : hop) options[pair.first] = pair.second;
+            continue;
+        }
+        if (hop.count("dwell_us") == 0 or std::stod(hop.at("dwell_us")) <= 0.0)
+        {
+            throw std::runtime_error("SoapyRemote::startHopping() missing dwell_us in "+entry);
+        }
+        hops.push_back(hop);
+    }
+
+    //the hop times are relative to the start of the table
+    SoapySDR::KwargsList commands;
+    long long offsetNs = 0;
+    for (size_t i = 0; i < hops.size(); i++)
+    {
+        const auto &hop = hops[i];
+        SoapySDR::Kwargs command;
+        command["index"] = std::to_string(i);
+        command["time"] = std::to_string(offsetNs);
+        const auto chanIt = options.find("channel");
+        if (chanIt != options.end()) command["channel"] = chanIt->second;
+        const auto cmdIt = options.find("command");
+        if (cmdIt != options.end()) command["command"] = cmdIt->second;
+
+        //the gain and antenna are switched before the frequency of the hop
+        if (hop.count("antenna") != 0)
+        {
+            command["call"] = "setAntenna";
+            command["name"] = hop.at("antenna");
+            commands.push_back(command);
+            command.erase("name");
+        }
+        if (hop.count("gain") != 0)
+        {
+            command["call"] = "setGain";
+            command["value"] = hop.at("gain");
+            commands.push_back(command);
+        }
+        command["call"] = "setFrequency";
+        command["value"] = hop.at("freq");
+        commands.push_back(command);
+
+        offsetNs += (long long)(std::stod(hop.at("dwell_us"))*1e3);
+    }
+
+    const auto repeatIt = options.find("repeat");
+    periodNs = (repeatIt != options.end() and repeatIt->second == "false")?0:offsetNs;
+    return commands;
+}
+
+void SoapyRemoteDevice::startHopping(const std::string &spec)
+{
+    SoapySDR::Kwargs options;
+    long long periodNs = 0;
+    auto commands = parseHoppingTable(spec, options, periodNs);
+    if (not commands.empty() and _remoteRPCVersion < SoapyRPCVersionHopping)
+    {
+        throw std::runtime_error("SoapyRemote::startHopping() server does not support remote:hop");
+    }
+
+    delete _hopTable;
+    _hopTable = nullptr;
+    if (commands.empty()) return;
+
+    //the server takes the direction as a number
+    const auto dirIt = options.find("direction");
+    const std::string direction = (dirIt == options.end())?"rx":dirIt->second;
+    const bool isTx = (direction == "tx" or direction == "TX" or direction == std::to_string(SOAPY_SDR_TX));
+
+    //start now on the hardware clock unless a time was given
+    long long startNs = 0;
+    const auto timeIt = options.find("time");
+    if (timeIt != options.end()) startNs = std::stoll(timeIt->second);
+    else
+    {
+        SoapyRPCPacker packer(_sock);
+        packer & SOAPY_REMOTE_GET_HARDWARE_TIME;
+        packer & std::string();
+        packer();
+        SoapyRPCUnpacker unpacker(_sock);
+        unpacker & startNs;
+    }
+
+    for (auto &command : commands)
+    {
+        command["direction"] = std::to_string(isTx?SOAPY_SDR_TX:SOAPY_SDR_RX);
+        command["time"] = std::to_string(startNs + std::stoll(command.at("time")));
+    }
+    _hopTable = new SoapyCommandQueue(_url, _args, commands, _timeoutUs, periodNs);
+}
+
+/*******************************************************************
+ * Spectrum sweep:
+ * The server tunes, captures, and reduces the samples of every step,
+ * so that only the power results cross the network.
+ ******************************************************************/
+
+void SoapyRemoteDevice::startSweep(const std::string &spec)
+{
+    const auto plan = SoapySDR::KwargsFromString(spec);
+    if (not plan.empty() and _remoteRPCVersion < SoapyRPCVersionSweep)
+    {
+        throw std::runtime_error("SoapyRemote::startSweep() server does not support remote:sweep");
+    }
+
+    delete _sweepReceiver;
+    _sweepReceiver = nullptr;
+    if (plan.empty()) return;
+    _sweepReceiver = new SoapySweepReceiver(_url, _args, plan, _timeoutUs);
+}
+
+/*******************************************************************
+ * Transaction script:
+ * The register and bus operations of a script are executed
+ * by the server in one call instead of one call per operation.
+ ******************************************************************/
+
+void SoapyRemoteDevice::runScript(const std::string &spec)
+{
+    if (_remoteRPCVersion < SoapyRPCVersionScript)
+    {
+        throw std::runtime_error("SoapyRemote::runScript() server does not support remote:script");
+    }
+
+    SoapySDR::KwargsList ops;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ';'))
+    {
+        const auto op = SoapySDR::KwargsFromString(entry);
+        if (not op.empty()) ops.push_back(op);
+    }
+
+    //the script runs after the setters held in an open batch
+    if (_batch != nullptr)
+    {
+        this->endBatch();
+        this->beginBatch();
+    }
+
+    //the writes of the script are not known to the shadow
+    this->clearShadow(nullptr);
+
+    SoapyRPCPacker packer(_sock);
+    packer & SOAPY_REMOTE_RUN_SCRIPT;
+    packer & ops;
+    packer();
+
+    SoapyRPCUnpacker unpacker(_sock);
+    std::vector<std::string> results;
+    unpacker & results;
+
+    _scriptResults.clear();
+    for (const auto &result : results)
+    {
+        if (not _scriptResults.empty()) _scriptResults += ", ";
+        _scriptResults += result;
+    }
+}
+
 /*******************************************************************
  * Identification API
  ******************************************************************/
@@ -121,13 +777,13 @@ SoapySDR::Kwargs SoapyRemoteDevice::getHardwareInfo(void) const
 void SoapyRemoteDevice::setFrontendMapping(const int direction, const std::string &mapping)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    this->clearCache();
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_FRONTEND_MAPPING;
     packer & char(direction);
     packer & mapping;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::getFrontendMapping(const int direction) const
@@ -195,6 +851,10 @@ bool SoapyRemoteDevice::getFullDuplex(const int direction, const size_t channel)
 std::vector<std::string> SoapyRemoteDevice::listAntennas(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_LIST_ANTENNAS, direction, channel);
+    const auto it = _cachedStrings.find(key);
+    if (it != _cachedStrings.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_LIST_ANTENNAS;
     packer & char(direction);
@@ -204,6 +864,7 @@ std::vector<std::string> SoapyRemoteDevice::listAntennas(const int direction, co
     SoapyRPCUnpacker unpacker(_sock);
     std::vector<std::string> result;
     unpacker & result;
+    if (_cache) _cachedStrings[key] = result;
     return result;
 }
 
@@ -211,13 +872,12 @@ void SoapyRemoteDevice::setAntenna(const int direction, const size_t channel, co
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_ANTENNA;
     packer & char(direction);
     packer & int(channel);
     packer & name;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::getAntenna(const int direction, const size_t channel) const
@@ -258,13 +918,12 @@ void SoapyRemoteDevice::setDCOffsetMode(const int direction, const size_t channe
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_DC_OFFSET_MODE;
     packer & char(direction);
     packer & int(channel);
     packer & automatic;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 bool SoapyRemoteDevice::getDCOffsetMode(const int direction, const size_t channel) const
@@ -301,13 +960,12 @@ void SoapyRemoteDevice::setDCOffset(const int direction, const size_t channel, c
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_DC_OFFSET;
     packer & char(direction);
     packer & int(channel);
     packer & offset;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::complex<double> SoapyRemoteDevice::getDCOffset(const int direction, const size_t channel) const
@@ -344,13 +1002,12 @@ void SoapyRemoteDevice::setIQBalance(const int direction, const size_t channel,
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_IQ_BALANCE_MODE;
     packer & char(direction);
     packer & int(channel);
     packer & balance;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::complex<double> SoapyRemoteDevice::getIQBalance(const int direction, const size_t channel) const
@@ -402,13 +1059,12 @@ void SoapyRemoteDevice::setIQBalanceMode(const int direction, const size_t chann
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_IQ_BALANCE_MODE_AUTO;
     packer & char(direction);
     packer & int(channel);
     packer & automatic;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 bool SoapyRemoteDevice::getIQBalanceMode(const int direction, const size_t channel) const
@@ -430,13 +1086,12 @@ void SoapyRemoteDevice::setFrequencyCorrection(const int direction, const size_t
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_FREQUENCY_CORRECTION;
     packer & char(direction);
     packer & int(channel);
     packer & value;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 double SoapyRemoteDevice::getFrequencyCorrection(const int direction, const size_t channel) const
@@ -492,13 +1147,12 @@ void SoapyRemoteDevice::setGainMode(const int direction, const size_t channel, c
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_GAIN_MODE;
     packer & char(direction);
     packer & int(channel);
     packer & automatic;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 bool SoapyRemoteDevice::getGainMode(const int direction, const size_t channel) const
@@ -519,28 +1173,36 @@ bool SoapyRemoteDevice::getGainMode(const int direction, const size_t channel) c
 void SoapyRemoteDevice::setGain(const int direction, const size_t channel, const double value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_GAIN, direction, channel, "");
+    const std::string shadow(shadowValue(value));
+    if (this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, &shadowKey);
     packer & SOAPY_REMOTE_SET_GAIN;
     packer & char(direction);
     packer & int(channel);
     packer & value;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    this->recordWrite(shadowKey, shadow);
 }
 
 void SoapyRemoteDevice::setGain(const int direction, const size_t channel, const std::string &name, const double value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_GAIN, direction, channel, name);
+    const std::string shadow(shadowValue(value));
+    if (this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, &shadowKey);
     packer & SOAPY_REMOTE_SET_GAIN_ELEMENT;
     packer & char(direction);
     packer & int(channel);
     packer & name;
     packer & value;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    this->recordWrite(shadowKey, shadow);
 }
 
 double SoapyRemoteDevice::getGain(const int direction, const size_t channel) const
@@ -577,6 +1239,10 @@ double SoapyRemoteDevice::getGain(const int direction, const size_t channel, con
 SoapySDR::Range SoapyRemoteDevice::getGainRange(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_GET_GAIN_RANGE, direction, channel);
+    const auto it = _cachedRange.find(key);
+    if (it != _cachedRange.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_GAIN_RANGE;
     packer & char(direction);
@@ -586,6 +1252,7 @@ SoapySDR::Range SoapyRemoteDevice::getGainRange(const int direction, const size_
     SoapyRPCUnpacker unpacker(_sock);
     SoapySDR::Range result;
     unpacker & result;
+    if (_cache) _cachedRange[key] = result;
     return result;
 }
 
@@ -612,35 +1279,47 @@ SoapySDR::Range SoapyRemoteDevice::getGainRange(const int direction, const size_
 void SoapyRemoteDevice::setFrequency(const int direction, const size_t channel, const double frequency, const SoapySDR::Kwargs &args)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_FREQUENCY, direction, channel, "");
+    const std::string shadow(shadowValue(frequency));
+    if (args.empty() and this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, args.empty()?&shadowKey:nullptr);
     packer & SOAPY_REMOTE_SET_FREQUENCY;
     packer & char(direction);
     packer & int(channel);
     packer & frequency;
     packer & args;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    if (args.empty()) this->recordWrite(shadowKey, shadow);
 }
 
 void SoapyRemoteDevice::setFrequency(const int direction, const size_t channel, const std::string &name, const double frequency, const SoapySDR::Kwargs &args)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_FREQUENCY, direction, channel, name);
+    const std::string shadow(shadowValue(frequency));
+    if (args.empty() and this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, args.empty()?&shadowKey:nullptr);
     packer & SOAPY_REMOTE_SET_FREQUENCY_COMPONENT;
     packer & char(direction);
     packer & int(channel);
     packer & name;
     packer & frequency;
     packer & args;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    if (args.empty()) this->recordWrite(shadowKey, shadow);
 }
 
 double SoapyRemoteDevice::getFrequency(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_FREQUENCY, direction, channel, "");
+    std::string shadow;
+    if (this->findRead(shadowKey, shadow)) return shadowDouble(shadow);
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_FREQUENCY;
     packer & char(direction);
@@ -650,12 +1329,17 @@ double SoapyRemoteDevice::getFrequency(const int direction, const size_t channel
     SoapyRPCUnpacker unpacker(_sock);
     double result;
     unpacker & result;
+    this->recordRead(shadowKey, shadowValue(result));
     return result;
 }
 
 double SoapyRemoteDevice::getFrequency(const int direction, const size_t channel, const std::string &name) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_SET_FREQUENCY, direction, channel, name);
+    std::string shadow;
+    if (this->findRead(shadowKey, shadow)) return shadowDouble(shadow);
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_FREQUENCY_COMPONENT;
     packer & char(direction);
@@ -666,6 +1350,7 @@ double SoapyRemoteDevice::getFrequency(const int direction, const size_t channel
     SoapyRPCUnpacker unpacker(_sock);
     double result;
     unpacker & result;
+    this->recordRead(shadowKey, shadowValue(result));
     return result;
 }
 
@@ -687,6 +1372,10 @@ std::vector<std::string> SoapyRemoteDevice::listFrequencies(const int direction,
 SoapySDR::RangeList SoapyRemoteDevice::getFrequencyRange(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_GET_FREQUENCY_RANGE, direction, channel);
+    const auto it = _cachedRangeList.find(key);
+    if (it != _cachedRangeList.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_FREQUENCY_RANGE;
     packer & char(direction);
@@ -696,6 +1385,7 @@ SoapySDR::RangeList SoapyRemoteDevice::getFrequencyRange(const int direction, co
     SoapyRPCUnpacker unpacker(_sock);
     SoapySDR::RangeList result;
     unpacker & result;
+    if (_cache) _cachedRangeList[key] = result;
     return result;
 }
 
@@ -738,13 +1428,12 @@ void SoapyRemoteDevice::setSampleRate(const int direction, const size_t channel,
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_SAMPLE_RATE;
     packer & char(direction);
     packer & int(channel);
     packer & rate;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 double SoapyRemoteDevice::getSampleRate(const int direction, const size_t channel) const
@@ -765,6 +1454,10 @@ double SoapyRemoteDevice::getSampleRate(const int direction, const size_t channe
 std::vector<double> SoapyRemoteDevice::listSampleRates(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_LIST_SAMPLE_RATES, direction, channel);
+    const auto it = _cachedDoubles.find(key);
+    if (it != _cachedDoubles.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_LIST_SAMPLE_RATES;
     packer & char(direction);
@@ -774,6 +1467,7 @@ std::vector<double> SoapyRemoteDevice::listSampleRates(const int direction, cons
     SoapyRPCUnpacker unpacker(_sock);
     std::vector<double> result;
     unpacker & result;
+    if (_cache) _cachedDoubles[key] = result;
     return result;
 }
 
@@ -800,13 +1494,12 @@ void SoapyRemoteDevice::setBandwidth(const int direction, const size_t channel,
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_BANDWIDTH;
     packer & char(direction);
     packer & int(channel);
     packer & bw;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 double SoapyRemoteDevice::getBandwidth(const int direction, const size_t channel) const
@@ -861,12 +1554,12 @@ SoapySDR::RangeList SoapyRemoteDevice::getBandwidthRange(const int direction, co
 void SoapyRemoteDevice::setMasterClockRate(const double rate)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    this->clearCache();
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_MASTER_CLOCK_RATE;
     packer & rate;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 double SoapyRemoteDevice::getMasterClockRate(void) const
@@ -899,11 +1592,10 @@ void SoapyRemoteDevice::setReferenceClockRate(const double rate)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_REF_CLOCK_RATE;
     packer & rate;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 double SoapyRemoteDevice::getReferenceClockRate(void) const
@@ -949,11 +1641,10 @@ void SoapyRemoteDevice::setClockSource(const std::string &source)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_CLOCK_SOURCE;
     packer & source;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::getClockSource(void) const
@@ -990,11 +1681,10 @@ void SoapyRemoteDevice::setTimeSource(const std::string &source)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_TIME_SOURCE;
     packer & source;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::getTimeSource(void) const
@@ -1042,24 +1732,22 @@ void SoapyRemoteDevice::setHardwareTime(const long long timeNs, const std::strin
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_HARDWARE_TIME;
     packer & timeNs;
     packer & what;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 void SoapyRemoteDevice::setCommandTime(const long long timeNs, const std::string &what)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_SET_COMMAND_TIME;
     packer & timeNs;
     packer & what;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 /*******************************************************************
@@ -1095,6 +1783,9 @@ SoapySDR::ArgInfo SoapyRemoteDevice::getSensorInfo(const std::string &name) cons
 
 std::string SoapyRemoteDevice::readSensor(const std::string &name) const
 {
+    std::string value;
+    if (this->readSubscribedSensor(-1, 0, name, value)) return value;
+
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_READ_SENSOR;
@@ -1140,6 +1831,9 @@ SoapySDR::ArgInfo SoapyRemoteDevice::getSensorInfo(const int direction, const si
 
 std::string SoapyRemoteDevice::readSensor(const int direction, const size_t channel, const std::string &name) const
 {
+    std::string value;
+    if (this->readSubscribedSensor(direction, channel, name, value)) return value;
+
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_READ_CHANNEL_SENSOR;
@@ -1175,13 +1869,12 @@ void SoapyRemoteDevice::writeRegister(const std::string &name, const unsigned ad
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_REGISTER_NAMED;
     packer & name;
     packer & int(addr);
     packer & int(value);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 unsigned SoapyRemoteDevice::readRegister(const std::string &name, const unsigned addr) const
@@ -1203,12 +1896,11 @@ void SoapyRemoteDevice::writeRegister(const unsigned addr, const unsigned value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_REGISTER;
     packer & int(addr);
     packer & int(value);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 unsigned SoapyRemoteDevice::readRegister(const unsigned addr) const
@@ -1229,14 +1921,13 @@ void SoapyRemoteDevice::writeRegisters(const std::string &name, const unsigned a
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     std::vector<size_t> val (value.begin(), value.end());
     packer & SOAPY_REMOTE_WRITE_REGISTERS;
     packer & name;
     packer & int(addr);
     packer & val;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::vector<unsigned> SoapyRemoteDevice::readRegisters(const std::string &name, const unsigned addr, const size_t length) const
@@ -1263,31 +1954,167 @@ std::vector<unsigned> SoapyRemoteDevice::readRegisters(const std::string &name,
 SoapySDR::ArgInfoList SoapyRemoteDevice::getSettingInfo(void) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    SoapyRPCPacker packer(_sock);
-    packer & SOAPY_REMOTE_GET_SETTING_INFO;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    const CacheKey key(SOAPY_REMOTE_GET_SETTING_INFO, 0, 0);
     SoapySDR::ArgInfoList result;
-    unpacker & result;
+    const auto it = _cachedArgInfo.find(key);
+    if (it != _cachedArgInfo.end()) result = it->second;
+    else
+    {
+        SoapyRPCPacker packer(_sock);
+        packer & SOAPY_REMOTE_GET_SETTING_INFO;
+        packer();
+
+        SoapyRPCUnpacker unpacker(_sock);
+        unpacker & result;
+        if (_cache) _cachedArgInfo[key] = result;
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionBatch)
+    {
+        SoapySDR::ArgInfo batchArg;
+        batchArg.key = SOAPY_REMOTE_KWARG_BATCH;
+        batchArg.value = "false";
+        batchArg.type = SoapySDR::ArgInfo::BOOL;
+        batchArg.description = "Hold the setter calls and send them as one call when set back to false.";
+        batchArg.name = "Remote Batch";
+        result.push_back(batchArg);
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionSensors)
+    {
+        SoapySDR::ArgInfo sensorsArg;
+        sensorsArg.key = SOAPY_REMOTE_KWARG_SENSORS;
+        sensorsArg.value = "";
+        sensorsArg.type = SoapySDR::ArgInfo::STRING;
+        sensorsArg.description = "Subscribe to sensors pushed by the server: [rx<N>/|tx<N>/]name[:ms][:change],...";
+        sensorsArg.name = "Remote Sensors";
+        result.push_back(sensorsArg);
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionCommandQueue)
+    {
+        SoapySDR::ArgInfo queueArg;
+        queueArg.key = SOAPY_REMOTE_KWARG_QUEUE;
+        queueArg.value = "";
+        queueArg.type = SoapySDR::ArgInfo::STRING;
+        queueArg.description = "Execute commands on the server at hardware times: time=<ns>, call=<name>, ...; ...";
+        queueArg.name = "Remote Queue";
+        result.push_back(queueArg);
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionHopping)
+    {
+        SoapySDR::ArgInfo hopArg;
+        hopArg.key = SOAPY_REMOTE_KWARG_HOP;
+        hopArg.value = "";
+        hopArg.type = SoapySDR::ArgInfo::STRING;
+        hopArg.description = "Run a hopping table on the server: freq=<Hz>, dwell_us=<us>[, gain=<dB>][, antenna=<name>]; ...";
+        hopArg.name = "Remote Hopping";
+        result.push_back(hopArg);
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionSweep)
+    {
+        SoapySDR::ArgInfo sweepArg;
+        sweepArg.key = SOAPY_REMOTE_KWARG_SWEEP;
+        sweepArg.value = "";
+        sweepArg.type = SoapySDR::ArgInfo::STRING;
+        sweepArg.description = "Run a sweep on the server: start=<Hz>, stop=<Hz>, step=<Hz>, settle_us=<us>, samples=<n>[, fft=<n>]";
+        sweepArg.name = "Remote Sweep";
+        result.push_back(sweepArg);
+    }
+
+    if (_remoteRPCVersion >= SoapyRPCVersionScript)
+    {
+        SoapySDR::ArgInfo scriptArg;
+        scriptArg.key = SOAPY_REMOTE_KWARG_SCRIPT;
+        scriptArg.value = "";
+        scriptArg.type = SoapySDR::ArgInfo::STRING;
+        scriptArg.description = "Run register and bus operations on the server: op=<write|read|poll|wait|...>, addr=<n>, ...; ...";
+        scriptArg.name = "Remote Script";
+        result.push_back(scriptArg);
+    }
+
     return result;
 }
 
 void SoapyRemoteDevice::writeSetting(const std::string &key, const std::string &value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    if (key == SOAPY_REMOTE_KWARG_SENSORS)
+    {
+        this->subscribeSensors(value);
+        return;
+    }
+
+    if (key == SOAPY_REMOTE_KWARG_QUEUE)
+    {
+        this->queueCommands(value);
+        return;
+    }
+
+    if (key == SOAPY_REMOTE_KWARG_HOP)
+    {
+        this->startHopping(value);
+        return;
+    }
+
+    if (key == SOAPY_REMOTE_KWARG_SWEEP)
+    {
+        this->startSweep(value);
+        return;
+    }
+
+    if (key == SOAPY_REMOTE_KWARG_SCRIPT)
+    {
+        this->runScript(value);
+        return;
+    }
+
+    if (key == SOAPY_REMOTE_KWARG_BATCH)
+    {
+        if (value == "true") this->beginBatch();
+        else this->endBatch();
+        return;
+    }
+
+    const ShadowKey shadowKey(SOAPY_REMOTE_WRITE_SETTING, 0, 0, key);
+    const std::string shadow(value);
+    if (this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, &shadowKey);
     packer & SOAPY_REMOTE_WRITE_SETTING;
     packer & key;
     packer & value;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    this->recordWrite(shadowKey, shadow);
 }
 
 std::string SoapyRemoteDevice::readSetting(const std::string &key) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    if (key == SOAPY_REMOTE_KWARG_QUEUE)
+    {
+        if (_commandQueue == nullptr) return "";
+        return _commandQueue->reports();
+    }
+    if (key == SOAPY_REMOTE_KWARG_HOP)
+    {
+        if (_hopTable == nullptr) return "";
+        return _hopTable->reports();
+    }
+    if (key == SOAPY_REMOTE_KWARG_SWEEP)
+    {
+        if (_sweepReceiver == nullptr) return "";
+        return _sweepReceiver->results();
+    }
+    if (key == SOAPY_REMOTE_KWARG_SCRIPT) return _scriptResults;
+
+    const ShadowKey shadowKey(SOAPY_REMOTE_WRITE_SETTING, 0, 0, key);
+    std::string shadow;
+    if (this->findRead(shadowKey, shadow)) return shadow;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_READ_SETTING;
     packer & key;
@@ -1296,12 +2123,17 @@ std::string SoapyRemoteDevice::readSetting(const std::string &key) const
     SoapyRPCUnpacker unpacker(_sock);
     std::string result;
     unpacker & result;
+    this->recordRead(shadowKey, result);
     return result;
 }
 
 SoapySDR::ArgInfoList SoapyRemoteDevice::getSettingInfo(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO, direction, channel);
+    const auto it = _cachedArgInfo.find(key);
+    if (it != _cachedArgInfo.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO;
     packer & char(direction);
@@ -1311,26 +2143,35 @@ SoapySDR::ArgInfoList SoapyRemoteDevice::getSettingInfo(const int direction, con
     SoapyRPCUnpacker unpacker(_sock);
     SoapySDR::ArgInfoList result;
     unpacker & result;
+    if (_cache) _cachedArgInfo[key] = result;
     return result;
 }
 
 void SoapyRemoteDevice::writeSetting(const int direction, const size_t channel, const std::string &key, const std::string &value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_WRITE_CHANNEL_SETTING, direction, channel, key);
+    const std::string shadow(value);
+    if (this->isRedundantWrite(shadowKey, shadow)) return;
+
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer, &shadowKey);
     packer & SOAPY_REMOTE_WRITE_CHANNEL_SETTING;
     packer & char(direction);
     packer & int(channel);
     packer & key;
     packer & value;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
+    this->recordWrite(shadowKey, shadow);
 }
 
 std::string SoapyRemoteDevice::readSetting(const int direction, const size_t channel, const std::string &key) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const ShadowKey shadowKey(SOAPY_REMOTE_WRITE_CHANNEL_SETTING, direction, channel, key);
+    std::string shadow;
+    if (this->findRead(shadowKey, shadow)) return shadow;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_READ_CHANNEL_SETTING;
     packer & char(direction);
@@ -1341,6 +2182,7 @@ std::string SoapyRemoteDevice::readSetting(const int direction, const size_t cha
     SoapyRPCUnpacker unpacker(_sock);
     std::string result;
     unpacker & result;
+    this->recordRead(shadowKey, result);
     return result;
 }
 
@@ -1365,25 +2207,23 @@ void SoapyRemoteDevice::writeGPIO(const std::string &bank, const unsigned value)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_GPIO;
     packer & bank;
     packer & int(value);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 void SoapyRemoteDevice::writeGPIO(const std::string &bank, const unsigned value, const unsigned mask)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_GPIO_MASKED;
     packer & bank;
     packer & int(value);
     packer & int(mask);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 unsigned SoapyRemoteDevice::readGPIO(const std::string &bank) const
@@ -1404,25 +2244,23 @@ void SoapyRemoteDevice::writeGPIODir(const std::string &bank, const unsigned dir
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_GPIO_DIR;
     packer & bank;
     packer & int(dir);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 void SoapyRemoteDevice::writeGPIODir(const std::string &bank, const unsigned dir, const unsigned mask)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_GPIO_DIR_MASKED;
     packer & bank;
     packer & int(dir);
     packer & int(mask);
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 unsigned SoapyRemoteDevice::readGPIODir(const std::string &bank) const
@@ -1447,12 +2285,11 @@ void SoapyRemoteDevice::writeI2C(const int addr, const std::string &data)
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_I2C;
     packer & int(addr);
     packer & data;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::readI2C(const int addr, const size_t numBytes)
@@ -1511,12 +2348,11 @@ void SoapyRemoteDevice::writeUART(const std::string &which, const std::string &d
 {
     std::lock_guard<std::mutex> lock(_mutex);
     SoapyRPCPacker packer(_sock);
+    this->packPipelined(packer);
     packer & SOAPY_REMOTE_WRITE_UART;
     packer & which;
     packer & data;
-    packer();
-
-    SoapyRPCUnpacker unpacker(_sock);
+    this->sendPipelined(packer);
 }
 
 std::string SoapyRemoteDevice::readUART(const std::string &which, const long timeoutUs) const
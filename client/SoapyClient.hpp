@@ -6,8 +6,14 @@
 #include "SoapyRPCSocket.hpp"
 #include <SoapySDR/Device.hpp>
 #include <mutex>
+#include <map>
+#include <tuple>
 
 class SoapyLogAcceptor;
+class SoapyRPCPacker;
+class SoapySensorSubscriber;
+class SoapyCommandQueue;
+class SoapySweepReceiver;
 
 class SoapyRemoteDevice : public SoapySDR::Device
 {
@@ -377,9 +383,75 @@ public:
     std::string readUART(const std::string &which, const long timeoutUs) const;
 
 private:
+    //choose the remote format and wire format for remote:format=auto
+    std::string selectAutoFormat(const int direction, const std::string &localFormat,
+        const std::vector<size_t> &channels, const std::string &nativeFormat, SoapySDR::Kwargs &args);
+
+    //written values per call, direction, channel, and name, see remote:shadow
+    typedef std::tuple<int, int, size_t, std::string> ShadowKey;
+    bool isShadowed(const ShadowKey &shadowKey) const;
+    bool isRedundantWrite(const ShadowKey &shadowKey, const std::string &shadow) const;
+    void recordWrite(const ShadowKey &shadowKey, const std::string &shadow);
+    bool findRead(const ShadowKey &shadowKey, std::string &shadow) const;
+    void recordRead(const ShadowKey &shadowKey, const std::string &shadow) const;
+    void clearShadow(const ShadowKey *shadowKey);
+
+    //sensors pushed by the server, see remote:sensors
+    void subscribeSensors(const std::string &spec);
+    bool readSubscribedSensor(const int direction, const size_t channel, const std::string &name, std::string &value) const;
+
+    //timed commands executed on the server, see remote:queue
+    void queueCommands(const std::string &spec);
+
+    //hopping table executed on the server, see remote:hop
+    void startHopping(const std::string &spec);
+
+    //spectrum sweep run on the server, see remote:sweep
+    void startSweep(const std::string &spec);
+
+    //transaction script run on the server, see remote:script
+    void runScript(const std::string &spec);
+
+    //begin and end a setter call, see remote:pipeline and remote:batch,
+    //clears the shadow of the key or the whole shadow without a key
+    void packPipelined(SoapyRPCPacker &packer, const ShadowKey *shadowKey = nullptr);
+    void sendPipelined(SoapyRPCPacker &packer);
+    void sendBatch(const SoapyRPCPacker &calls, const int numCalls) const;
+    void beginBatch(void);
+    void endBatch(void);
+
+    //properties that do not change after make, see remote:cache
+    typedef std::tuple<int, int, size_t> CacheKey; //call, direction, channel
+    void prefetchCache(void);
+    void clearCache(void);
+
     SoapySocketSession _sess;
     mutable SoapyRPCSocket _sock;
     SoapyLogAcceptor *_logAcceptor;
     mutable std::mutex _mutex;
     std::string _defaultStreamProt;
+    unsigned int _remoteRPCVersion; //features supported by the server
+    bool _pipeline; //setters do not wait for their replies
+    int _nextRequestId;
+    SoapyRPCPacker *_batch; //setter calls held for remote:batch
+    int _batchCalls;
+    bool _batchClearsCache;
+    bool _cache;
+    mutable std::map<CacheKey, std::vector<std::string>> _cachedStrings;
+    mutable std::map<CacheKey, SoapySDR::Range> _cachedRange;
+    mutable std::map<CacheKey, SoapySDR::RangeList> _cachedRangeList;
+    mutable std::map<CacheKey, std::vector<double>> _cachedDoubles;
+    mutable std::map<CacheKey, SoapySDR::ArgInfoList> _cachedArgInfo;
+    bool _shadow;
+    std::map<ShadowKey, std::string> _shadowWrites; //last written values
+    mutable std::map<ShadowKey, std::string> _shadowReads; //values read back since
+    const std::string _url;
+    const SoapySDR::Kwargs _args;
+    long _timeoutUs;
+    mutable std::mutex _sensorMutex;
+    SoapySensorSubscriber *_sensorSubscriber;
+    SoapyCommandQueue *_commandQueue; //guarded by _mutex
+    SoapyCommandQueue *_hopTable; //guarded by _mutex
+    SoapySweepReceiver *_sweepReceiver; //guarded by _mutex
+    std::string _scriptResults; //guarded by _mutex
 };
@@ -10,12 +10,153 @@
 #include "SoapyRPCPacker.hpp"
 #include "SoapyRPCUnpacker.hpp"
 #include "SoapyStreamEndpoint.hpp"
+#include "SoapyStreamCodec.hpp"
+#include "ClientConvertPool.hpp"
 #include <algorithm> //std::min, std::find
 #include <memory> //unique_ptr
+#include <sstream>
+#include <iomanip> //setprecision
+#include <cctype> //tolower
+
+//the default scale factor is the max signed integer or 1.0 for floats
+static double defaultScaleFactor(const std::string &format)
+{
+    if (format.find('F') != std::string::npos) return 1.0;
+    return double(1 << ((SoapySDR::formatToSize(format)*4)-1));
+}
+
+//bits of resolution per component, the mantissa for float formats
+static size_t formatResolution(const std::string &format)
+{
+    if (format == SOAPY_SDR_CF64) return 53;
+    if (format == SOAPY_SDR_CF32) return 24;
+    if (format == SOAPY_REMOTE_CF16) return 11;
+    return SoapySDR::formatToSize(format)*4;
+}
+
+//relative CPU cost of a conversion: a copy, a SIMD kernel, or a generic kernel
+static int convertCost(const ConvertKernel *kernel)
+{
+    if (kernel->recv == nullptr) return 0;
+    return (std::string(kernel->isa) == "generic")?2:1;
+}
+
+/***********************************************************************
+ * Automatic remote format selection:
+ * Each candidate is a wire format that the client converts into the local format,
+ * either a device format, a server-side conversion of the native format,
+ * or block floating point of a CS16 wire format. The network bits of each
+ * candidate are compared against the bandwidth limit, including the datagram
+ * headers. The choice keeps the native resolution with the fewest bits,
+ * or else the most resolution that fits, and the least CPU cost on ties.
+ **********************************************************************/
+struct AutoFormat
+{
+    std::string remoteFormat;
+    std::string wireFormat;
+    std::string compress;
+    double bitsPerElem; //on the network
+    size_t resolution; //capped at the native resolution
+    int cpuCost;
+};
+
+std::string SoapyRemoteDevice::selectAutoFormat(const int direction, const std::string &localFormat,
+    const std::vector<size_t> &channels, const std::string &nativeFormat, SoapySDR::Kwargs &args)
+{
+    const size_t nativeResolution = formatResolution(nativeFormat);
+    const bool userConvert = args.count(SOAPY_REMOTE_KWARG_CONVERT) != 0;
+    const bool userCompress = args.count(SOAPY_REMOTE_KWARG_COMPRESS) != 0;
+    std::vector<AutoFormat> candidates;
+    auto addCandidate = [&](const std::string &remoteFormat, const std::string &wireFormat, const int serverCost)
+    {
+        const auto kernel = findConvertKernel(localFormat, wireFormat);
+        if (kernel == nullptr) return;
+        AutoFormat candidate;
+        candidate.remoteFormat = remoteFormat;
+        candidate.wireFormat = wireFormat;
+        candidate.compress = "none";
+        candidate.bitsPerElem = SoapySDR::formatToSize(wireFormat)*8.0;
+        candidate.resolution = std::min(formatResolution(wireFormat), nativeResolution);
+        candidate.cpuCost = convertCost(kernel) + serverCost;
+        candidates.push_back(candidate);
+
+        //block floating point adds an exponent byte per 64 components
+        if (wireFormat != SOAPY_SDR_CS16 or userCompress or _remoteRPCVersion < SoapyRPCVersionCompress) return;
+        for (const size_t mantBits : {12, 8})
+        {
+            candidate.compress = "bfp"+std::to_string(mantBits);
+            candidate.bitsPerElem = 2*(mantBits + 8.0/64);
+            candidate.resolution = std::min(mantBits, nativeResolution);
+            candidate.cpuCost += 2;
+            candidates.push_back(candidate);
+        }
+    };
+
+    //the device formats converted on the client
+    for (const auto &format : this->__getRemoteOnlyStreamFormats(direction, channels.front()))
+    {
+        addCandidate(format, format, 0);
+    }
+
+    //the native format converted on the server into any wire format
+    if (not userConvert and _remoteRPCVersion >= SoapyRPCVersionServerConvert)
+    {
+        for (const auto &wireFormat : getConvertLocalFormats({nativeFormat}))
+        {
+            const auto kernel = findConvertKernel(wireFormat, nativeFormat);
+            if (wireFormat != nativeFormat and kernel != nullptr) addCandidate(nativeFormat, wireFormat, convertCost(kernel));
+        }
+    }
+    if (candidates.empty()) throw std::runtime_error(
+        "SoapyRemote::setupStream() remote:format=auto found no format for localFormat="+localFormat);
+
+    //the required bits per second of each candidate against the limit
+    double bandwidth = 0.0;
+    const auto bandwidthIt = args.find(SOAPY_REMOTE_KWARG_BANDWIDTH);
+    if (bandwidthIt != args.end()) bandwidth = std::stod(bandwidthIt->second);
+    size_t mtu = SOAPY_REMOTE_DEFAULT_ENDPOINT_MTU;
+    const auto mtuIt = args.find(SOAPY_REMOTE_KWARG_MTU);
+    if (mtuIt != args.end()) mtu = size_t(std::stod(mtuIt->second));
+    const double headerBytes = 72.0; //IPv6, UDP, and stream datagram headers
+    const double framing = (mtu > 2*headerBytes)?(mtu/(mtu-headerBytes)):2.0;
+    const double rate = this->getSampleRate(direction, channels.front());
+    const double elemsPerSec = rate*channels.size()*framing;
+    auto fits = [&](const AutoFormat &c){return bandwidth <= 0.0 or c.bitsPerElem*elemsPerSec <= bandwidth;};
+
+    //prefer what fits, then resolution, then fewer bits, then less CPU
+    auto better = [&](const AutoFormat &a, const AutoFormat &b)
+    {
+        if (fits(a) != fits(b)) return fits(a);
+        if (not fits(a) and a.bitsPerElem != b.bitsPerElem) return a.bitsPerElem < b.bitsPerElem;
+        if (a.resolution != b.resolution) return a.resolution > b.resolution;
+        if (a.bitsPerElem != b.bitsPerElem) return a.bitsPerElem < b.bitsPerElem;
+        return a.cpuCost < b.cpuCost;
+    };
+    const auto best = *std::min_element(candidates.begin(), candidates.end(), better);
+
+    SoapySDR::logf(fits(best)?SOAPY_SDR_INFO:SOAPY_SDR_WARNING,
+        "SoapyRemote::setupStream(remote:format=auto) %s%s%s%s for %g Msps x %d channels: %g Mbit/s, limit %s",
+        best.wireFormat.c_str(), (best.wireFormat == best.remoteFormat)?"":(" from server-side "+best.remoteFormat).c_str(),
+        (best.compress == "none")?"":" with ", (best.compress == "none")?"":best.compress.c_str(),
+        rate/1e6, int(channels.size()), best.bitsPerElem*elemsPerSec/1e6,
+        (bandwidth <= 0.0)?"none":(std::to_string(bandwidth/1e6)+" Mbit/s").c_str());
+
+    if (best.wireFormat != best.remoteFormat)
+    {
+        args[SOAPY_REMOTE_KWARG_CONVERT] = "server";
+        args[SOAPY_REMOTE_KWARG_WIRE_FORMAT] = best.wireFormat;
+    }
+    if (best.compress != "none") args[SOAPY_REMOTE_KWARG_COMPRESS] = best.compress;
+    return best.remoteFormat;
+}
 
 std::vector<std::string> SoapyRemoteDevice::__getRemoteOnlyStreamFormats(const int direction, const size_t channel) const
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    const CacheKey key(SOAPY_REMOTE_GET_STREAM_FORMATS, direction, channel);
+    const auto it = _cachedStrings.find(key);
+    if (it != _cachedStrings.end()) return it->second;
+
     SoapyRPCPacker packer(_sock);
     packer & SOAPY_REMOTE_GET_STREAM_FORMATS;
     packer & char(direction);
@@ -25,21 +166,14 @@ std::vector<std::string> SoapyRemoteDevice::__getRemoteOnlyStreamFormats(const i
     SoapyRPCUnpacker unpacker(_sock);
     std::vector<std::string> result;
     unpacker & result;
+    if (_cache) _cachedStrings[key] = result;
     return result;
 }
 
 std::vector<std::string> SoapyRemoteDevice::getStreamFormats(const int direction, const size_t channel) const
 {
-    auto formats = __getRemoteOnlyStreamFormats(direction, channel);
-
-    //add complex floats when a conversion is possible
-    const bool hasCF32 = std::find(formats.begin(), formats.end(), SOAPY_SDR_CF32) != formats.end();
-    const bool hasCS16 = std::find(formats.begin(), formats.end(), SOAPY_SDR_CS16) != formats.end();
-    const bool hasCS8 = std::find(formats.begin(), formats.end(), SOAPY_SDR_CS8) != formats.end();
-    const bool hasCU8 = std::find(formats.begin(), formats.end(), SOAPY_SDR_CU8) != formats.end();
-    if (not hasCF32 and (hasCS16 or hasCS8 or hasCU8)) formats.push_back(SOAPY_SDR_CF32);
-
-    return formats;
+    //add the local formats that the remote formats can convert into
+    return getConvertLocalFormats(__getRemoteOnlyStreamFormats(direction, channel));
 }
 
 std::string SoapyRemoteDevice::getNativeStreamFormat(const int direction, const size_t channel, double &fullScale) const
@@ -83,8 +217,18 @@ SoapySDR::ArgInfoList SoapyRemoteDevice::getStreamArgsInfo(const int direction,
     formatArg.description = "The stream format used on the remote device.";
     formatArg.type = SoapySDR::ArgInfo::STRING;
     formatArg.options = __getRemoteOnlyStreamFormats(direction, channel);
+    formatArg.options.push_back("auto");
     result.push_back(formatArg);
 
+    SoapySDR::ArgInfo bandwidthArg;
+    bandwidthArg.key = "remote:bandwidth";
+    bandwidthArg.value = "0";
+    bandwidthArg.name = "Remote Bandwidth";
+    bandwidthArg.units = "bits/s";
+    bandwidthArg.description = "The network bandwidth limit for remote:format=auto, zero for no limit.";
+    bandwidthArg.type = SoapySDR::ArgInfo::FLOAT;
+    result.push_back(bandwidthArg);
+
     SoapySDR::ArgInfo scaleArg;
     scaleArg.key = "remote:scale";
     scaleArg.value = std::to_string(fullScale);
@@ -129,6 +273,89 @@ SoapySDR::ArgInfoList SoapyRemoteDevice::getStreamArgsInfo(const int direction,
     protArg.options = {"udp", "tcp", "none"};
     result.push_back(protArg);
 
+    if (direction == SOAPY_SDR_RX)
+    {
+        SoapySDR::ArgInfo maxLatencyArg;
+        maxLatencyArg.key = "remote:max_latency_us";
+        maxLatencyArg.value = "0";
+        maxLatencyArg.name = "Remote Max Latency";
+        maxLatencyArg.units = "us";
+        maxLatencyArg.description = "How long the server may hold samples to fill a datagram before forwarding.";
+        maxLatencyArg.type = SoapySDR::ArgInfo::INT;
+        result.push_back(maxLatencyArg);
+    }
+
+    SoapySDR::ArgInfo convertArg;
+    convertArg.key = "remote:convert";
+    convertArg.value = "client";
+    convertArg.name = "Remote Convert";
+    convertArg.description = "Convert the stream format on the client or in the server before the network.";
+    convertArg.type = SoapySDR::ArgInfo::STRING;
+    convertArg.options = {"client", "server"};
+    result.push_back(convertArg);
+
+    SoapySDR::ArgInfo wireFormatArg;
+    wireFormatArg.key = "remote:wire_format";
+    wireFormatArg.value = "";
+    wireFormatArg.name = "Remote Wire Format";
+    wireFormatArg.description = "The stream format on the network with server conversion, the local format by default.";
+    wireFormatArg.type = SoapySDR::ArgInfo::STRING;
+    result.push_back(wireFormatArg);
+
+    SoapySDR::ArgInfo compressArg;
+    compressArg.key = "remote:compress";
+    compressArg.value = "none";
+    compressArg.name = "Remote Compress";
+    compressArg.description = "Compression of the stream payloads on the network: lossless for CS16, CS8, and CU8, or block floating point for CS16.";
+    compressArg.type = SoapySDR::ArgInfo::STRING;
+    compressArg.options = {"none", "lossless", "bfp8", "bfp12"};
+    result.push_back(compressArg);
+
+    SoapySDR::ArgInfo adaptArg;
+    adaptArg.key = "remote:adapt";
+    adaptArg.value = "false";
+    adaptArg.name = "Remote Adapt";
+    adaptArg.description = "Narrow a CS16 stream to CS12 or CS8 on the network while it is congested.";
+    adaptArg.type = SoapySDR::ArgInfo::BOOL;
+    result.push_back(adaptArg);
+
+    SoapySDR::ArgInfo convertThreadsArg;
+    convertThreadsArg.key = "remote:convert_threads";
+    convertThreadsArg.value = "0";
+    convertThreadsArg.name = "Remote Convert Threads";
+    convertThreadsArg.description = "Number of client threads to split format conversion across channels.";
+    convertThreadsArg.type = SoapySDR::ArgInfo::INT;
+    result.push_back(convertThreadsArg);
+
+    SoapySDR::ArgInfo convertThresholdArg;
+    convertThresholdArg.key = "remote:convert_threshold";
+    convertThresholdArg.value = std::to_string(SOAPY_REMOTE_DEFAULT_CONVERT_THRESHOLD);
+    convertThresholdArg.name = "Remote Convert Threshold";
+    convertThresholdArg.units = "samples";
+    convertThresholdArg.description = "Minimum samples per call across all channels to use the conversion threads.";
+    convertThresholdArg.type = SoapySDR::ArgInfo::INT;
+    result.push_back(convertThresholdArg);
+
+    if (direction == SOAPY_SDR_TX)
+    {
+        SoapySDR::ArgInfo scheduleArg;
+        scheduleArg.key = "remote:schedule";
+        scheduleArg.value = "false";
+        scheduleArg.name = "Remote Schedule";
+        scheduleArg.description = "Queue timed bursts on the server and drop bursts that are already late.";
+        scheduleArg.type = SoapySDR::ArgInfo::BOOL;
+        result.push_back(scheduleArg);
+
+        SoapySDR::ArgInfo scheduleLeadArg;
+        scheduleLeadArg.key = "remote:schedule_lead_us";
+        scheduleLeadArg.value = std::to_string(SOAPY_REMOTE_DEFAULT_SCHEDULE_LEAD_US);
+        scheduleLeadArg.name = "Remote Schedule Lead";
+        scheduleLeadArg.units = "us";
+        scheduleLeadArg.description = "How long before its time a scheduled burst is written to the device.";
+        scheduleLeadArg.type = SoapySDR::ArgInfo::INT;
+        result.push_back(scheduleLeadArg);
+    }
+
     return result;
 }
 
@@ -171,26 +398,86 @@ SoapySDR::Stream *SoapyRemoteDevice::setupStream(
     //use the remote device's native stream format and scale factor when the conversion is supported
     double nativeScaleFactor = 0.0;
     auto nativeFormat = this->getNativeStreamFormat(direction, channels.front(), nativeScaleFactor);
-    const bool useNative = (localFormat == nativeFormat) or
-        (localFormat == SOAPY_SDR_CF32 and nativeFormat == SOAPY_SDR_CS16) or
-        (localFormat == SOAPY_SDR_CF32 and nativeFormat == SOAPY_SDR_CS12) or
-        (localFormat == SOAPY_SDR_CS16 and nativeFormat == SOAPY_SDR_CS12) or
-        (localFormat == SOAPY_SDR_CS16 and nativeFormat == SOAPY_SDR_CS8) or
-        (localFormat == SOAPY_SDR_CF32 and nativeFormat == SOAPY_SDR_CS8) or
-        (localFormat == SOAPY_SDR_CF32 and nativeFormat == SOAPY_SDR_CU8);
+    const bool useNative = findConvertKernel(localFormat, nativeFormat) != nullptr;
 
     //use the native format when the conversion is supported,
     //otherwise use the client's local format for the default
     auto remoteFormat = useNative?nativeFormat:localFormat;
     const auto remoteFormatIt = args.find(SOAPY_REMOTE_KWARG_FORMAT);
     if (remoteFormatIt != args.end()) remoteFormat = remoteFormatIt->second;
+    if (remoteFormat == "auto") remoteFormat = this->selectAutoFormat(direction, localFormat, channels, nativeFormat, args);
 
-    //use the native scale factor when the remote format is native,
-    //otherwise the default scale factor is the max signed integer
-    double scaleFactor = (remoteFormat == nativeFormat)?nativeScaleFactor:double(1 << ((SoapySDR::formatToSize(remoteFormat)*4)-1));
+    //remote:format=BFP8 or BFP12 is shorthand for CS16 with block floating point
+    std::string compress = "none";
+    std::string remoteFormatLower(remoteFormat);
+    std::transform(remoteFormatLower.begin(), remoteFormatLower.end(), remoteFormatLower.begin(), ::tolower);
+    if (remoteFormatLower == "bfp8" or remoteFormatLower == "bfp12")
+    {
+        compress = remoteFormatLower;
+        remoteFormat = SOAPY_SDR_CS16;
+    }
+
+    //use the native scale factor when the remote format is native
+    double scaleFactor = (remoteFormat == nativeFormat)?nativeScaleFactor:defaultScaleFactor(remoteFormat);
     const auto scaleFactorIt = args.find(SOAPY_REMOTE_KWARG_SCALE);
     if (scaleFactorIt != args.end()) scaleFactor = std::stod(scaleFactorIt->second);
 
+    //select the side that converts from the remote format,
+    //the server converts into the wire format before the network,
+    //and the client converts the wire format with its default scale
+    std::string convertSide = "client";
+    const auto convertIt = args.find(SOAPY_REMOTE_KWARG_CONVERT);
+    if (convertIt != args.end()) convertSide = convertIt->second;
+    if (convertSide != "client" and convertSide != "server") throw std::runtime_error(
+        "SoapyRemote::setupStream() conversion side not supported;"
+        "expected 'client' or 'server', but got '"+convertSide+"'");
+    std::string wireFormat = remoteFormat;
+    double wireScaleFactor = scaleFactor;
+    if (convertSide == "server")
+    {
+        if (_remoteRPCVersion < SoapyRPCVersionServerConvert) throw std::runtime_error(
+            "SoapyRemote::setupStream() remote:convert=server is not supported by this server version");
+        wireFormat = localFormat;
+        const auto wireFormatIt = args.find(SOAPY_REMOTE_KWARG_WIRE_FORMAT);
+        if (wireFormatIt != args.end()) wireFormat = wireFormatIt->second;
+        if (findConvertKernel(wireFormat, remoteFormat) == nullptr) throw std::runtime_error(
+            "SoapyRemote::setupStream() server conversion not supported;"
+            "wireFormat="+wireFormat+", remoteFormat="+remoteFormat);
+        args[SOAPY_REMOTE_KWARG_WIRE_FORMAT] = wireFormat;
+        std::ostringstream scaleFactorStr;
+        scaleFactorStr << std::setprecision(17) << scaleFactor;
+        args[SOAPY_REMOTE_KWARG_SCALE] = scaleFactorStr.str();
+        wireScaleFactor = (wireFormat == remoteFormat)?scaleFactor:defaultScaleFactor(wireFormat);
+    }
+    args[SOAPY_REMOTE_KWARG_CONVERT] = convertSide;
+
+    //the payload codec applies to the format on the network
+    const auto compressIt = args.find(SOAPY_REMOTE_KWARG_COMPRESS);
+    if (compressIt != args.end()) compress = compressIt->second;
+    if (compress != "none")
+    {
+        if (_remoteRPCVersion < SoapyRPCVersionCompress) throw std::runtime_error(
+            "SoapyRemote::setupStream() remote:compress is not supported by this server version");
+        if (not SoapyStreamCodec::isSupported(compress, wireFormat)) throw std::runtime_error(
+            "SoapyRemote::setupStream() compression not supported;"
+            "compress="+compress+", wireFormat="+wireFormat);
+    }
+    args[SOAPY_REMOTE_KWARG_COMPRESS] = compress;
+
+    //the adaptive wire format narrows a CS16 format on the network
+    bool adaptive = false;
+    const auto adaptIt = args.find(SOAPY_REMOTE_KWARG_ADAPT);
+    if (adaptIt != args.end()) adaptive = (adaptIt->second == "true");
+    if (adaptive)
+    {
+        if (_remoteRPCVersion < SoapyRPCVersionAdaptive) throw std::runtime_error(
+            "SoapyRemote::setupStream() remote:adapt is not supported by this server version");
+        if (wireFormat != SOAPY_SDR_CS16 or compress != "none") throw std::runtime_error(
+            "SoapyRemote::setupStream() adaptive wire format not supported;"
+            "wireFormat="+wireFormat+", compress="+compress);
+    }
+    args[SOAPY_REMOTE_KWARG_ADAPT] = adaptive?"true":"false";
+
     //determine reliable stream mode with tcp or datagram mode
     const bool datagramMode = (prot == "udp");
     if (prot == "udp") {}
@@ -210,30 +497,37 @@ SoapySDR::Stream *SoapyRemoteDevice::setupStream(
     if (windowIt != args.end()) window = size_t(std::stod(windowIt->second));
     args[SOAPY_REMOTE_KWARG_WINDOW] = std::to_string(window);
 
-    SoapySDR::logf(SOAPY_SDR_INFO, "SoapyRemote::setup%sStream(remoteFormat=%s, localFormat=%s, scaleFactor=%g, mtu=%d, window=%d)",
-        (direction == SOAPY_SDR_RX)?"Rx":"Tx", remoteFormat.c_str(), localFormat.c_str(), scaleFactor, int(mtu), int(window));
+    SoapySDR::logf(SOAPY_SDR_INFO, "SoapyRemote::setup%sStream(remoteFormat=%s, localFormat=%s, scaleFactor=%g, mtu=%d, window=%d, convert=%s, wireFormat=%s, compress=%s, adapt=%s)",
+        (direction == SOAPY_SDR_RX)?"Rx":"Tx", remoteFormat.c_str(), localFormat.c_str(), scaleFactor, int(mtu), int(window), convertSide.c_str(), wireFormat.c_str(), compress.c_str(), adaptive?"true":"false");
 
     //check supported formats
-    ConvertTypes convertType = CONVERT_MEMCPY;
-    if (localFormat == remoteFormat) convertType = CONVERT_MEMCPY;
-    else if (localFormat == SOAPY_SDR_CF32 and remoteFormat == SOAPY_SDR_CS16) convertType = CONVERT_CF32_CS16;
-    else if (localFormat == SOAPY_SDR_CF32 and remoteFormat == SOAPY_SDR_CS12) convertType = CONVERT_CF32_CS12;
-    else if (localFormat == SOAPY_SDR_CS16 and remoteFormat == SOAPY_SDR_CS12) convertType = CONVERT_CS16_CS12;
-    else if (localFormat == SOAPY_SDR_CS16 and remoteFormat == SOAPY_SDR_CS8) convertType = CONVERT_CS16_CS8;
-    else if (localFormat == SOAPY_SDR_CF32 and remoteFormat == SOAPY_SDR_CS8) convertType = CONVERT_CF32_CS8;
-    else if (localFormat == SOAPY_SDR_CF32 and remoteFormat == SOAPY_SDR_CU8) convertType = CONVERT_CF32_CU8;
-    else throw std::runtime_error(
+    const ConvertKernel *convertKernel = findConvertKernel(localFormat, wireFormat);
+    if (convertKernel == nullptr) throw std::runtime_error(
         "SoapyRemote::setupStream() conversion not supported;"
-        "localFormat="+localFormat+", remoteFormat="+remoteFormat);
+        "localFormat="+localFormat+", remoteFormat="+wireFormat);
 
     //allocate new local stream data
     auto data = std::unique_ptr<ClientStreamData>(new ClientStreamData());
     data->localFormat = localFormat;
-    data->remoteFormat = remoteFormat;
+    data->remoteFormat = wireFormat;
     data->recvBuffs.resize(channels.size());
     data->sendBuffs.resize(channels.size());
-    data->convertType = convertType;
-    data->scaleFactor = scaleFactor;
+    data->convertKernel = convertKernel;
+    data->scaleFactor = wireScaleFactor;
+    data->localElemSize = SoapySDR::formatToSize(localFormat);
+    SoapySDR::logf(SOAPY_SDR_DEBUG, "SoapyRemote::setupStream() converter instruction set: %s", data->convertKernel->isa);
+
+    //create the conversion pool when there is a conversion to split up
+    size_t convertThreads = 0;
+    const auto convertThreadsIt = args.find(SOAPY_REMOTE_KWARG_CONVERT_THREADS);
+    if (convertThreadsIt != args.end()) convertThreads = size_t(std::stoul(convertThreadsIt->second));
+    data->convertThreshold = SOAPY_REMOTE_DEFAULT_CONVERT_THRESHOLD;
+    const auto convertThresholdIt = args.find(SOAPY_REMOTE_KWARG_CONVERT_THRESHOLD);
+    if (convertThresholdIt != args.end()) data->convertThreshold = size_t(std::stoul(convertThresholdIt->second));
+    if (convertThreads != 0 and convertKernel->recv != nullptr)
+    {
+        data->convertPool = new ClientConvertPool(convertThreads);
+    }
 
     //extract socket node information
     const auto localNode = SoapyURL(_sock.getsockname()).getNode();
@@ -320,7 +614,9 @@ SoapySDR::Stream *SoapyRemoteDevice::setupStream(
     //create endpoint
     data->endpoint = new SoapyStreamEndpoint(data->streamSock, data->statusSock,
         datagramMode, direction == SOAPY_SDR_RX, channels.size(),
-        SoapySDR::formatToSize(remoteFormat), mtu, window);
+        SoapySDR::formatToSize(wireFormat), mtu, window);
+    if (compress != "none") data->endpoint->enableCodec(compress, wireFormat);
+    if (adaptive) data->endpoint->enableAdaptive(wireFormat);
 
     return (SoapySDR::Stream *)data.release();
 }
@@ -338,6 +634,7 @@ void SoapyRemoteDevice::closeStream(SoapySDR::Stream *stream)
     SoapyRPCUnpacker unpacker(_sock);
 
     //cleanup local stream data
+    data->logConvertStats();
     delete data->endpoint;
     delete data;
 }
@@ -403,6 +700,15 @@ int SoapyRemoteDevice::readStream(
 {
     auto data = (ClientStreamData *)stream;
 
+    //receive straight into the user's buffers when there is no conversion,
+    //no remainder, and the buffers can hold the largest possible datagram
+    if (data->convertKernel->recv == nullptr and data->readElemsLeft == 0 and numElems >= data->endpoint->getBuffSize())
+    {
+        auto ep = data->endpoint;
+        if (not ep->waitRecv(timeoutUs)) return SOAPY_SDR_TIMEOUT;
+        return ep->recvBuffs(buffs, flags, timeNs);
+    }
+
     //call into direct buffer access (when there is no remainder)
     if (data->readElemsLeft == 0)
     {
@@ -446,6 +752,20 @@ int SoapyRemoteDevice::writeStream(
 {
     auto data = (ClientStreamData *)stream;
 
+    //send straight from the user's buffers when there is no conversion
+    if (data->convertKernel->send == nullptr)
+    {
+        auto ep = data->endpoint;
+        if (not ep->waitSend(timeoutUs)) return SOAPY_SDR_TIMEOUT;
+
+        //only end burst if the last sample can be sent
+        const size_t numSamples = std::min(ep->getBuffSize(), numElems);
+        if (numSamples < numElems) flags &= ~(SOAPY_SDR_END_BURST);
+
+        ep->sendBuffs(buffs, int(numSamples), flags, timeNs);
+        return numSamples;
+    }
+
     //acquire from direct buffer access
     size_t handle = 0;
     int ret = this->acquireWriteBuffer(stream, handle, data->sendBuffs.data(), timeoutUs);
@@ -0,0 +1,51 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SweepReceiver.hpp"
+#include "SoapyRPCPacker.hpp"
+#include "SoapyRPCUnpacker.hpp"
+#include <cstdio> //snprintf
+
+SoapySweepReceiver::SoapySweepReceiver(const std::string &url, const SoapySDR::Kwargs &args,
+    const SoapySDR::Kwargs &plan, const long timeoutUs):
+    _connection("SoapySweepReceiver", url, args,
+        [&plan](SoapyRPCPacker &packer)
+        {
+            packer & SOAPY_REMOTE_START_SWEEP;
+            packer & plan;
+        },
+        SOAPY_REMOTE_STOP_SWEEP,
+        [this](SoapyRPCUnpacker &unpacker){this->handleResult(unpacker);},
+        timeoutUs)
+{
+    return;
+}
+
+std::string SoapySweepReceiver::results(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::string results;
+    char buff[32];
+    for (const auto &pair : _results)
+    {
+        if (not results.empty()) results += "; ";
+        std::snprintf(buff, sizeof(buff), "%.0f:", pair.first);
+        results += buff;
+        for (const auto power : pair.second)
+        {
+            std::snprintf(buff, sizeof(buff), " %.2f", power);
+            results += buff;
+        }
+    }
+    return results;
+}
+
+void SoapySweepReceiver::handleResult(SoapyRPCUnpacker &unpacker)
+{
+    double freq = 0.0;
+    std::vector<double> powers;
+    unpacker & freq;
+    unpacker & powers;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _results[freq] = powers;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "PushConnection.hpp"
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+/*!
+ * The sweep receiver opens a push connection to the server,
+ * and starts a sweep of the plan on the same device there.
+ * The server captures and reduces the samples of every step,
+ * and pushes back the power results per frequency.
+ * The sweep is stopped on destruction if it did not finish yet.
+ */
+class SoapySweepReceiver
+{
+public:
+    SoapySweepReceiver(const std::string &url, const SoapySDR::Kwargs &args,
+        const SoapySDR::Kwargs &plan, const long timeoutUs);
+
+    //! Get the last power in dB per frequency as "freq: power...; ..."
+    std::string results(void);
+
+private:
+    void handleResult(SoapyRPCUnpacker &unpacker);
+
+    std::mutex _mutex;
+    std::map<double, std::vector<double>> _results;
+    SoapyPushConnection _connection; //last: the thread stops before the results go away
+};
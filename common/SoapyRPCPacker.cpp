@@ -34,6 +34,11 @@ SoapyRPCPacker::~SoapyRPCPacker(void)
     _message = NULL;
 }
 
+void SoapyRPCPacker::packCalls(const SoapyRPCPacker &calls)
+{
+    this->pack(calls._message+sizeof(SoapyRPCHeader), calls._size-sizeof(SoapyRPCHeader));
+}
+
 void SoapyRPCPacker::send(void)
 {
     //load the trailer
@@ -132,8 +137,8 @@ void SoapyRPCPacker::operator&(const SoapySDR::Range &value)
     *this & value.minimum();
     *this & value.maximum();
 
-    //a step size is sent when the remote version matches our current
-    if (_remoteRPCVersion >= SoapyRPCVersion)
+    //a step size is sent when the remote version supports it
+    if (_remoteRPCVersion >= SoapyRPCVersionRangeStep)
     {
         #ifdef SOAPY_SDR_API_HAS_RANGE_TYPE_STEP
         *this & value.step();
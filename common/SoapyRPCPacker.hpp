@@ -55,6 +55,23 @@ public:
         this->pack(char(value));
     }
 
+    //! Pack the calls of another packer into a batched call
+    void packCalls(const SoapyRPCPacker &calls);
+
+    //! Pack the request ID of a pipelined call, before the call
+    void packRequestId(const int id)
+    {
+        *this & SOAPY_REMOTE_REQUEST_ID;
+        *this & id;
+    }
+
+    //! Pack the ID of the reply to a pipelined call, before the result
+    void packReplyId(const int id)
+    {
+        *this & SOAPY_REMOTE_REPLY_ID;
+        *this & id;
+    }
+
     //! Pack a character
     void operator&(const char value);
 
@@ -445,6 +445,76 @@ int SoapyRPCSocket::recv(void *buf, size_t len, int flags)
     return ret;
 }
 
+//typical scatter/gather lists fit on the stack without allocation
+#define SOCKET_IOV_STACK 16
+
+int SoapyRPCSocket::sendv(const void * const *bufs, const size_t *lens, const size_t numBufs, int flags)
+{
+    #ifdef _MSC_VER
+    WSABUF iovStack[SOCKET_IOV_STACK];
+    std::vector<WSABUF> iovHeap((numBufs > SOCKET_IOV_STACK)?numBufs:0);
+    WSABUF *iov = iovHeap.empty()?iovStack:iovHeap.data();
+    for (size_t i = 0; i < numBufs; i++)
+    {
+        iov[i].buf = (char *)bufs[i];
+        iov[i].len = ULONG(lens[i]);
+    }
+    DWORD bytesSent = 0;
+    int ret = ::WSASend(_sock, iov, DWORD(numBufs), &bytesSent, DWORD(flags), NULL, NULL);
+    if (ret == 0) ret = int(bytesSent);
+    #else
+    struct iovec iovStack[SOCKET_IOV_STACK];
+    std::vector<struct iovec> iovHeap((numBufs > SOCKET_IOV_STACK)?numBufs:0);
+    struct iovec *iov = iovHeap.empty()?iovStack:iovHeap.data();
+    for (size_t i = 0; i < numBufs; i++)
+    {
+        iov[i].iov_base = (void *)bufs[i];
+        iov[i].iov_len = lens[i];
+    }
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = numBufs;
+    int ret = int(::sendmsg(_sock, &msg, flags | MSG_NOSIGNAL));
+    #endif
+    if (ret == -1) this->reportError("sendv()");
+    return ret;
+}
+
+int SoapyRPCSocket::recvv(void * const *bufs, const size_t *lens, const size_t numBufs, int flags)
+{
+    #ifdef _MSC_VER
+    WSABUF iovStack[SOCKET_IOV_STACK];
+    std::vector<WSABUF> iovHeap((numBufs > SOCKET_IOV_STACK)?numBufs:0);
+    WSABUF *iov = iovHeap.empty()?iovStack:iovHeap.data();
+    for (size_t i = 0; i < numBufs; i++)
+    {
+        iov[i].buf = (char *)bufs[i];
+        iov[i].len = ULONG(lens[i]);
+    }
+    DWORD bytesRecvd = 0;
+    DWORD recvFlags = DWORD(flags);
+    int ret = ::WSARecv(_sock, iov, DWORD(numBufs), &bytesRecvd, &recvFlags, NULL, NULL);
+    if (ret == 0) ret = int(bytesRecvd);
+    #else
+    struct iovec iovStack[SOCKET_IOV_STACK];
+    std::vector<struct iovec> iovHeap((numBufs > SOCKET_IOV_STACK)?numBufs:0);
+    struct iovec *iov = iovHeap.empty()?iovStack:iovHeap.data();
+    for (size_t i = 0; i < numBufs; i++)
+    {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = lens[i];
+    }
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = numBufs;
+    int ret = int(::recvmsg(_sock, &msg, flags));
+    #endif
+    if (ret == -1) this->reportError("recvv()");
+    return ret;
+}
+
 int SoapyRPCSocket::sendto(const void *buf, size_t len, const std::string &url, int flags)
 {
     SockAddrData addr; SoapyURL(url).toSockAddr(addr);
@@ -115,6 +115,18 @@ public:
      */
     int recv(void *buf, size_t len, int flags = 0);
 
+    /*!
+     * Send a list of buffers as a single message (gather).
+     * Return bytes sent or error.
+     */
+    int sendv(const void * const *bufs, const size_t *lens, const size_t numBufs, int flags = 0);
+
+    /*!
+     * Receive a single message into a list of buffers (scatter).
+     * Return bytes received or error.
+     */
+    int recvv(void * const *bufs, const size_t *lens, const size_t numBufs, int flags = 0);
+
     /*!
      * Send to a specific destination.
      */
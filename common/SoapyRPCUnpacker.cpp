@@ -35,7 +35,8 @@ SoapyRPCUnpacker::SoapyRPCUnpacker(SoapyRPCSocket &sock, const bool autoRecv, co
     _message(NULL),
     _offset(0),
     _capacity(0),
-    _remoteRPCVersion(SoapyRPCVersion)
+    _remoteRPCVersion(SoapyRPCVersion),
+    _requestId(-1)
 {
     //auto recv expects a reply packet within a reasonable time window
     //or else the link might be down, in which case we throw an error.
@@ -73,6 +74,36 @@ SoapyRPCUnpacker::~SoapyRPCUnpacker(void)
 }
 
 void SoapyRPCUnpacker::recv(void)
+{
+    //the server executes the calls of a connection in order,
+    //so the replies to earlier pipelined calls arrive first
+    while (this->recvMessage())
+    {
+        free(_message);
+        _message = NULL;
+        _offset = 0;
+        _capacity = 0;
+    }
+
+    //the first error of the pipelined calls fails this call
+    if (not _pipelineError.empty())
+    {
+        this->discard();
+        throw std::runtime_error(_pipelineError);
+    }
+}
+
+int SoapyRPCUnpacker::recvReply(void)
+{
+    if (not this->recvMessage())
+    {
+        throw std::runtime_error("SoapyRPCUnpacker::recvReply() FAIL: not a pipelined reply");
+    }
+    if (not _pipelineError.empty()) throw std::runtime_error(_pipelineError);
+    return _requestId;
+}
+
+bool SoapyRPCUnpacker::recvMessage(void)
 {
     //receive the header
     SoapyRPCHeader header;
@@ -119,6 +150,17 @@ void SoapyRPCUnpacker::recv(void)
         throw std::runtime_error("SoapyRPCUnpacker::recv() FAIL: trailer word");
     }
 
+    //consume the request or reply ID of a pipelined call
+    bool isReply = false;
+    _requestId = -1;
+    if (this->peekType() == SOAPY_REMOTE_REQUEST_ID or this->peekType() == SOAPY_REMOTE_REPLY_ID)
+    {
+        SoapyRemoteTypes type;
+        *this & type;
+        *this & _requestId;
+        isReply = (type == SOAPY_REMOTE_REPLY_ID);
+    }
+
     //auto-consume void
     if (this->peekType() == SOAPY_REMOTE_VOID)
     {
@@ -133,8 +175,14 @@ void SoapyRPCUnpacker::recv(void)
         std::string errorMsg;
         *this & type;
         *this & errorMsg;
-        throw std::runtime_error("RemoteError: "+errorMsg);
+        if (not isReply) throw std::runtime_error("RemoteError: "+errorMsg);
+        if (_pipelineError.empty()) _pipelineError = "RemoteError: "+errorMsg;
+        else SoapySDR::logf(SOAPY_SDR_ERROR, "SoapyRemote pipelined call %d failed: RemoteError: %s", _requestId, errorMsg.c_str());
     }
+
+    //pipelined calls do not return results
+    if (isReply) this->discard();
+    return isReply;
 }
 
 void SoapyRPCUnpacker::unpack(void *buff, const size_t length)
@@ -158,6 +206,16 @@ bool SoapyRPCUnpacker::done(void) const
     return (_offset + sizeof(SoapyRPCTrailer)) == _capacity;
 }
 
+size_t SoapyRPCUnpacker::remaining(void) const
+{
+    return _capacity - sizeof(SoapyRPCTrailer) - _offset;
+}
+
+void SoapyRPCUnpacker::discard(void)
+{
+    _offset = _capacity - sizeof(SoapyRPCTrailer);
+}
+
 #define UNPACK_TYPE_HELPER(expected) \
     SoapyRemoteTypes type; *this & type; \
     if (type != expected) {throw std::runtime_error("SoapyRPCUnpacker type check FAIL:" #expected);} else {}
@@ -231,8 +289,8 @@ void SoapyRPCUnpacker::operator&(SoapySDR::Range &value)
     *this & minimum;
     *this & maximum;
 
-    //a step size is sent when the remote version matches our current
-    if (_remoteRPCVersion >= SoapyRPCVersion)
+    //a step size is sent when the remote version supports it
+    if (_remoteRPCVersion >= SoapyRPCVersionRangeStep)
     {
         *this & step;
     }
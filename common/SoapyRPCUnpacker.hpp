@@ -21,9 +21,21 @@ public:
 
     ~SoapyRPCUnpacker(void);
 
-    //! Receive a complete RPC message
+    /*!
+     * Receive a complete RPC message.
+     * Replies to pipelined calls that arrive first are collected.
+     * The message is received and then the first error
+     * of the collected calls is thrown, the others are logged.
+     */
     void recv(void);
 
+    /*!
+     * Receive the reply to a pipelined call or throw.
+     * The error of the call is thrown.
+     * \return the request ID of the call
+     */
+    int recvReply(void);
+
     //! Unpack a binary blob of known size
     void unpack(void *buff, const size_t length);
 
@@ -41,6 +53,12 @@ public:
     //! Done when no data is left to unpack
     bool done(void) const;
 
+    //! The number of bytes left to unpack
+    size_t remaining(void) const;
+
+    //! Discard the data left to unpack
+    void discard(void);
+
     //! View the next type without consuming
     SoapyRemoteTypes peekType(void) const
     {
@@ -104,6 +122,12 @@ public:
     //! Unpack a list of arg infos
     void operator&(SoapySDR::ArgInfoList &value);
 
+    //! The request ID of a pipelined call or -1
+    int requestId(void) const
+    {
+        return _requestId;
+    }
+
     //! Get the received RPC version number
     unsigned int remoteRPCVersion(void) const
     {
@@ -114,9 +138,14 @@ private:
 
     void ensureSpace(const size_t length);
 
+    //receive one message, true for a pipelined reply
+    bool recvMessage(void);
+
     SoapyRPCSocket &_sock;
     char *_message;
     size_t _offset;
     size_t _capacity;
     unsigned int _remoteRPCVersion;
+    int _requestId;
+    std::string _pipelineError;
 };
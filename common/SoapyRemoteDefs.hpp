@@ -17,6 +17,13 @@
 //! Stream args key to set the format on the remote server
 #define SOAPY_REMOTE_KWARG_FORMAT (SOAPY_REMOTE_KWARG_PREFIX "format")
 
+/*!
+ * Stream args key for the network bandwidth limit in bits per second.
+ * With remote:format=auto, the stream uses the smallest wire format
+ * that keeps the device resolution, or the most resolution that fits.
+ */
+#define SOAPY_REMOTE_KWARG_BANDWIDTH (SOAPY_REMOTE_KWARG_PREFIX "bandwidth")
+
 //! Stream args key to set the scale for local float conversions
 #define SOAPY_REMOTE_KWARG_SCALE (SOAPY_REMOTE_KWARG_PREFIX "scale")
 
@@ -59,6 +66,152 @@
 //! Default thread priority is elevated for stream forwarding
 #define SOAPY_REMOTE_DEFAULT_THREAD_PRIORITY double(0.5)
 
+/*!
+ * Stream args key to set the receive latency budget in microseconds.
+ * The server keeps filling a partial datagram until the oldest sample
+ * has waited this long; zero forwards whatever data is already available.
+ */
+#define SOAPY_REMOTE_KWARG_MAX_LATENCY (SOAPY_REMOTE_KWARG_PREFIX "max_latency_us")
+
+/*!
+ * Stream args key to enable the server-side transmit burst scheduler.
+ * Timed bursts are queued and written to the device in time order,
+ * bursts that are already late are dropped and reported as time errors.
+ */
+#define SOAPY_REMOTE_KWARG_SCHEDULE (SOAPY_REMOTE_KWARG_PREFIX "schedule")
+
+/*!
+ * Stream args key for the scheduler lead time in microseconds.
+ * A queued burst is written to the device this long before its time.
+ */
+#define SOAPY_REMOTE_KWARG_SCHEDULE_LEAD (SOAPY_REMOTE_KWARG_PREFIX "schedule_lead_us")
+
+//! Default scheduler lead time gives the device time to buffer the burst
+#define SOAPY_REMOTE_DEFAULT_SCHEDULE_LEAD_US (10*1000) //10 ms
+
+/*!
+ * Stream args key for the number of client conversion threads.
+ * The threads split the format conversion of each call by channel,
+ * or by chunks of a channel; zero converts in the calling thread.
+ */
+#define SOAPY_REMOTE_KWARG_CONVERT_THREADS (SOAPY_REMOTE_KWARG_PREFIX "convert_threads")
+
+/*!
+ * Stream args key for the conversion thread pool threshold.
+ * Calls with fewer samples than this across all channels
+ * are converted in the calling thread.
+ */
+#define SOAPY_REMOTE_KWARG_CONVERT_THRESHOLD (SOAPY_REMOTE_KWARG_PREFIX "convert_threshold")
+
+//! Default threshold where the hand-off to the pool starts to pay off
+#define SOAPY_REMOTE_DEFAULT_CONVERT_THRESHOLD (64*1024)
+
+/*!
+ * Stream args key to select where the format conversion runs.
+ * "client" converts from the remote format on the client (default),
+ * "server" converts in the server's stream worker before the network.
+ */
+#define SOAPY_REMOTE_KWARG_CONVERT (SOAPY_REMOTE_KWARG_PREFIX "convert")
+
+/*!
+ * Stream args key for the format on the network with remote:convert=server.
+ * The default is the client's local format, so the client only copies.
+ */
+#define SOAPY_REMOTE_KWARG_WIRE_FORMAT (SOAPY_REMOTE_KWARG_PREFIX "wire_format")
+
+/*!
+ * Stream args key to compress the stream payload on the network.
+ * "none" sends the samples as is (default), "lossless" delta codes
+ * and bit packs each datagram of a CS16, CS8, or CU8 wire format.
+ * "bfp8" and "bfp12" send a CS16 wire format as block floating point
+ * with 8 or 12 bit mantissas, remote:format=BFP8 is a shorthand.
+ */
+#define SOAPY_REMOTE_KWARG_COMPRESS (SOAPY_REMOTE_KWARG_PREFIX "compress")
+
+/*!
+ * Stream args key to adapt a CS16 wire format to network congestion.
+ * When "true", the sender narrows datagrams to CS12 and then CS8
+ * after flow control stalls or loss, and steps back up when it clears.
+ * The receiver restores CS16, so the local format scale does not change.
+ */
+#define SOAPY_REMOTE_KWARG_ADAPT (SOAPY_REMOTE_KWARG_PREFIX "adapt")
+
+/*!
+ * Device setting key to batch the setter calls.
+ * Writing "true" holds the setter calls on the client,
+ * writing "false" sends them to the server as one call.
+ * The server handles the calls in order and stops at the first error.
+ */
+#define SOAPY_REMOTE_KWARG_BATCH (SOAPY_REMOTE_KWARG_PREFIX "batch")
+
+/*!
+ * Device setting key to subscribe to sensors pushed by the server.
+ * The value is a comma separated list of [rx<N>/|tx<N>/]name[:ms][:change],
+ * for a device sensor or a channel sensor, the sample period in
+ * milliseconds (1000 by default), and whether to push only changes.
+ * readSensor() answers the subscribed sensors from the pushed values.
+ * An empty value ends the subscription.
+ */
+#define SOAPY_REMOTE_KWARG_SENSORS (SOAPY_REMOTE_KWARG_PREFIX "sensors")
+
+/*!
+ * Device setting key to queue timed commands on the server.
+ * The value is a semicolon separated list of commands in markup,
+ * such as "time=1000000000, call=setFrequency, direction=rx, value=100e6".
+ * The keys are time (hardware time in ns), call (setFrequency, setGain,
+ * setAntenna, setSampleRate, setBandwidth, or writeSetting), direction,
+ * channel, name (component, element, antenna, or setting key), value,
+ * and command=true to use the device command time instead of waiting.
+ * Writing the setting replaces the queue, an empty value cancels it.
+ * Reading the setting gets the execution times in ns per command index,
+ * or the error of a command that failed.
+ */
+#define SOAPY_REMOTE_KWARG_QUEUE (SOAPY_REMOTE_KWARG_PREFIX "queue")
+
+/*!
+ * Device setting key to run a frequency hopping table on the server.
+ * The value is a semicolon separated list of hops in markup,
+ * such as "freq=100e6, dwell_us=500; freq=101e6, dwell_us=500, gain=20".
+ * The keys of a hop are freq (Hz), dwell_us, and the optional gain and antenna.
+ * An entry without freq sets the options of the whole table:
+ * direction, channel, time (hardware time of the first hop in ns),
+ * repeat=false to run the table once, and command=true
+ * to use the device command time instead of waiting.
+ * Writing the setting replaces the table, an empty value stops it.
+ * Reading the setting gets the hardware time in ns of the last boundary
+ * per hop index, to match against the stream timestamps.
+ */
+#define SOAPY_REMOTE_KWARG_HOP (SOAPY_REMOTE_KWARG_PREFIX "hop")
+
+/*!
+ * Device setting key to run a spectrum sweep on the server.
+ * The value is the plan in markup, such as
+ * "start=88e6, stop=108e6, step=2e6, settle_us=1000, samples=8192, fft=1024".
+ * The keys are start, stop, and step in Hz, or freqs as a space separated list,
+ * channel, settle_us (samples dropped after tuning), samples (capture length),
+ * fft (power of two, the mean power of the capture without it),
+ * and repeat=true to sweep until stopped.
+ * Writing the setting replaces the sweep, an empty value stops it.
+ * Reading the setting gets the results so far as a semicolon separated list
+ * of "freq: power..." in dB, with the FFT bins from low to high frequency.
+ */
+#define SOAPY_REMOTE_KWARG_SWEEP (SOAPY_REMOTE_KWARG_PREFIX "sweep")
+
+/*!
+ * Device setting key to run a register and bus transaction script
+ * on the server within one call.
+ * The value is a semicolon separated list of operations in markup,
+ * such as "op=write, addr=0x10, value=0x1, mask=0x1; op=read, addr=0x14".
+ * The operations are write, read, and poll (until the masked value matches,
+ * every interval_us=1000 up to timeout_us=1000000)
+ * of a register (addr and optional iface) or a gpio bank (bank),
+ * wait (us), gpio_write, gpio_read, i2c_write and i2c_read (hex bytes),
+ * and spi (addr, data, bits). Numbers are decimal or hex with 0x.
+ * Reading the setting gets the results of the read operations
+ * of the last script as a comma separated list.
+ */
+#define SOAPY_REMOTE_KWARG_SCRIPT (SOAPY_REMOTE_KWARG_PREFIX "script")
+
 /***********************************************************************
  * Socket defaults
  **********************************************************************/
@@ -101,7 +254,40 @@
  **********************************************************************/
 //major, minor, patch when this was last updated
 //bump the version number when changes are made
-static const unsigned int SoapyRPCVersion = 0x000400;
+static const unsigned int SoapyRPCVersion = 0x000e00;
+
+//! The first RPC version to send the step size of a range
+static const unsigned int SoapyRPCVersionRangeStep = 0x000400;
+
+//! The first RPC version to support remote:convert=server
+static const unsigned int SoapyRPCVersionServerConvert = 0x000500;
+
+//! The first RPC version to support remote:compress
+static const unsigned int SoapyRPCVersionCompress = 0x000600;
+
+//! The first RPC version to support remote:adapt
+static const unsigned int SoapyRPCVersionAdaptive = 0x000700;
+
+//! The first RPC version to support pipelined calls with request IDs
+static const unsigned int SoapyRPCVersionPipeline = 0x000800;
+
+//! The first RPC version to support batched calls
+static const unsigned int SoapyRPCVersionBatch = 0x000900;
+
+//! The first RPC version to support sensor subscriptions
+static const unsigned int SoapyRPCVersionSensors = 0x000a00;
+
+//! The first RPC version to support the timed command queue
+static const unsigned int SoapyRPCVersionCommandQueue = 0x000b00;
+
+//! The first RPC version to support the frequency hopping table
+static const unsigned int SoapyRPCVersionHopping = 0x000c00;
+
+//! The first RPC version to support the spectrum sweep
+static const unsigned int SoapyRPCVersionSweep = 0x000d00;
+
+//! The first RPC version to support transaction scripts
+static const unsigned int SoapyRPCVersionScript = 0x000e00;
 
 enum SoapyRemoteTypes
 {
@@ -124,7 +310,9 @@ enum SoapyRemoteTypes
     SOAPY_REMOTE_SIZE_LIST       = 16,
     SOAPY_REMOTE_ARG_INFO        = 17,
     SOAPY_REMOTE_ARG_INFO_LIST   = 18,
-    SOAPY_REMOTE_TYPE_MAX        = 19,
+    SOAPY_REMOTE_REQUEST_ID      = 19,
+    SOAPY_REMOTE_REPLY_ID        = 20,
+    SOAPY_REMOTE_TYPE_MAX        = 21,
 };
 
 enum SoapyRemoteCalls
@@ -140,6 +328,9 @@ enum SoapyRemoteCalls
     SOAPY_REMOTE_START_LOG_FORWARDING   = 21,
     SOAPY_REMOTE_STOP_LOG_FORWARDING    = 22,
 
+    //batch
+    SOAPY_REMOTE_BATCH           = 30,
+
     //identification
     SOAPY_REMOTE_GET_DRIVER_KEY      = 100,
     SOAPY_REMOTE_GET_HARDWARE_KEY    = 101,
@@ -237,6 +428,9 @@ enum SoapyRemoteCalls
     SOAPY_REMOTE_GET_HARDWARE_TIME        = 1101,
     SOAPY_REMOTE_SET_HARDWARE_TIME        = 1102,
     SOAPY_REMOTE_SET_COMMAND_TIME         = 1103,
+    SOAPY_REMOTE_QUEUE_COMMANDS           = 1104,
+    SOAPY_REMOTE_CANCEL_COMMANDS          = 1105,
+    SOAPY_REMOTE_REPEAT_COMMANDS          = 1106,
 
     //sensors
     SOAPY_REMOTE_LIST_SENSORS            = 1200,
@@ -245,6 +439,8 @@ enum SoapyRemoteCalls
     SOAPY_REMOTE_READ_CHANNEL_SENSOR     = 1203,
     SOAPY_REMOTE_GET_SENSOR_INFO         = 1204,
     SOAPY_REMOTE_GET_CHANNEL_SENSOR_INFO = 1205,
+    SOAPY_REMOTE_SUBSCRIBE_SENSORS       = 1206,
+    SOAPY_REMOTE_UNSUBSCRIBE_SENSORS     = 1207,
 
     //registers
     SOAPY_REMOTE_WRITE_REGISTER            = 1300,
@@ -254,6 +450,7 @@ enum SoapyRemoteCalls
     SOAPY_REMOTE_READ_REGISTER_NAMED       = 1304,
     SOAPY_REMOTE_WRITE_REGISTERS           = 1305,
     SOAPY_REMOTE_READ_REGISTERS            = 1306,
+    SOAPY_REMOTE_RUN_SCRIPT                = 1307,
 
     //settings
     SOAPY_REMOTE_WRITE_SETTING            = 1400,
@@ -283,6 +480,10 @@ enum SoapyRemoteCalls
     SOAPY_REMOTE_LIST_UARTS            = 1801,
     SOAPY_REMOTE_WRITE_UART            = 1802,
     SOAPY_REMOTE_READ_UART             = 1803,
+
+    //sweep
+    SOAPY_REMOTE_START_SWEEP           = 1900,
+    SOAPY_REMOTE_STOP_SWEEP            = 1901,
 };
 
 #define SOAPY_PACKET_WORD32(str) \
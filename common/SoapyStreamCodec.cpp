@@ -0,0 +1,269 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyStreamCodec.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <algorithm> //min
+#include <cstdint>
+#include <type_traits>
+
+//! Components per block, one width byte is stored for each block
+#define CODEC_BLOCK_SIZE 64
+
+/***********************************************************************
+ * Component helpers:
+ * The arithmetic wraps modulo the component size,
+ * so the deltas of any input values are reversible.
+ **********************************************************************/
+template <typename U>
+static inline U zigzagEncode(const U d)
+{
+    typedef typename std::make_signed<U>::type S;
+    return U(U(d << 1) ^ U(S(d) >> (sizeof(U)*8-1)));
+}
+
+template <typename U>
+static inline U zigzagDecode(const U z)
+{
+    return U((z >> 1) ^ U(-(z & 1)));
+}
+
+static inline unsigned bitWidth(uint32_t x)
+{
+    unsigned w = 0;
+    while (x != 0) {w++; x >>= 1;}
+    return w;
+}
+
+/***********************************************************************
+ * Lossless block coder:
+ * The components come in I and Q pairs, so every block is even.
+ * The delta and zigzag pass runs over a whole block into scratch
+ * so that the compiler can vectorize it,
+ * then the block is bit packed at the widest value.
+ **********************************************************************/
+template <typename U>
+static size_t encodeComponents(const U *in, const size_t numComps, uint8_t *out, const size_t maxBytes)
+{
+    U zz[CODEC_BLOCK_SIZE];
+    U prev[2] = {0, 0};
+    size_t outBytes = 0;
+
+    for (size_t i = 0; i < numComps; i += CODEC_BLOCK_SIZE)
+    {
+        const size_t n = std::min<size_t>(CODEC_BLOCK_SIZE, numComps-i);
+        const U *block = in+i;
+
+        //delta against the previous I or Q component
+        zz[0] = zigzagEncode<U>(U(block[0]-prev[0]));
+        zz[1] = zigzagEncode<U>(U(block[1]-prev[1]));
+        for (size_t j = 2; j < n; j++) zz[j] = zigzagEncode<U>(U(block[j]-block[j-2]));
+        prev[0] = block[n-2];
+        prev[1] = block[n-1];
+
+        U orBits = 0;
+        for (size_t j = 0; j < n; j++) orBits |= zz[j];
+        const unsigned width = bitWidth(orBits);
+
+        //the width byte and the packed block must fit
+        const size_t blockBytes = (n*width+7)/8;
+        if (outBytes+1+blockBytes > maxBytes) return 0;
+        out[outBytes++] = uint8_t(width);
+        if (width == 0) continue;
+
+        uint64_t acc = 0;
+        unsigned numBits = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            acc |= uint64_t(zz[j]) << numBits;
+            numBits += width;
+            while (numBits >= 8)
+            {
+                out[outBytes++] = uint8_t(acc);
+                acc >>= 8;
+                numBits -= 8;
+            }
+        }
+        if (numBits != 0) out[outBytes++] = uint8_t(acc);
+    }
+
+    return outBytes;
+}
+
+template <typename U>
+static size_t decodeComponents(const uint8_t *in, const size_t numBytes, U *out, const size_t numComps)
+{
+    U prev[2] = {0, 0};
+    size_t inBytes = 0;
+
+    for (size_t i = 0; i < numComps; i += CODEC_BLOCK_SIZE)
+    {
+        const size_t n = std::min<size_t>(CODEC_BLOCK_SIZE, numComps-i);
+        U *block = out+i;
+
+        if (inBytes >= numBytes) return 0;
+        const unsigned width = in[inBytes++];
+        if (width > sizeof(U)*8) return 0;
+        const size_t blockBytes = (n*width+7)/8;
+        if (inBytes+blockBytes > numBytes) return 0;
+
+        //unpack the zigzag values into the output block
+        const uint64_t mask = (uint64_t(1) << width)-1;
+        uint64_t acc = 0;
+        unsigned numBits = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            while (numBits < width)
+            {
+                acc |= uint64_t(in[inBytes++]) << numBits;
+                numBits += 8;
+            }
+            block[j] = zigzagDecode<U>(U(acc & mask));
+            acc >>= width;
+            numBits -= width;
+        }
+
+        //integrate the deltas per I or Q component
+        block[0] = U(block[0]+prev[0]);
+        block[1] = U(block[1]+prev[1]);
+        for (size_t j = 2; j < n; j++) block[j] = U(block[j]+block[j-2]);
+        prev[0] = block[n-2];
+        prev[1] = block[n-1];
+    }
+
+    return inBytes;
+}
+
+/***********************************************************************
+ * Block floating point coder:
+ * The exponent is the smallest shift that fits the widest component
+ * of the block into the signed mantissa. The components are rounded
+ * to the nearest mantissa, and the rounding overflow saturates.
+ * 12 bit mantissas are packed in pairs of components into 3 bytes.
+ **********************************************************************/
+static size_t blockFloatBytes(const size_t numComps, const size_t mantBits)
+{
+    const size_t numBlocks = (numComps+CODEC_BLOCK_SIZE-1)/CODEC_BLOCK_SIZE;
+    return numBlocks + (numComps*mantBits)/8;
+}
+
+template <int MantBits>
+static size_t encodeBlockFloat(const int16_t *in, const size_t numComps, uint8_t *out, const size_t maxBytes)
+{
+    static const int mantMax = (1 << (MantBits-1))-1;
+    if (blockFloatBytes(numComps, MantBits) > maxBytes) return 0;
+
+    int16_t mant[CODEC_BLOCK_SIZE];
+    size_t outBytes = 0;
+
+    for (size_t i = 0; i < numComps; i += CODEC_BLOCK_SIZE)
+    {
+        const size_t n = std::min<size_t>(CODEC_BLOCK_SIZE, numComps-i);
+        const int16_t *block = in+i;
+
+        //the widest magnitude plus the sign bit sets the exponent
+        uint16_t magBits = 0;
+        for (size_t j = 0; j < n; j++) magBits |= uint16_t(block[j] ^ (block[j] >> 15));
+        const unsigned width = bitWidth(magBits)+1;
+        const unsigned exp = (width > MantBits)?(width-MantBits):0;
+        out[outBytes++] = uint8_t(exp);
+
+        const int round = (exp == 0)?0:(1 << (exp-1));
+        for (size_t j = 0; j < n; j++) mant[j] = int16_t(std::min(mantMax, (int(block[j])+round) >> exp));
+
+        if (MantBits == 8) for (size_t j = 0; j < n; j++)
+        {
+            out[outBytes++] = uint8_t(mant[j]);
+        }
+        else for (size_t j = 0; j < n; j += 2)
+        {
+            const uint16_t m0 = uint16_t(mant[j+0]) & 0xfff;
+            const uint16_t m1 = uint16_t(mant[j+1]) & 0xfff;
+            out[outBytes++] = uint8_t(m0);
+            out[outBytes++] = uint8_t((m0 >> 8) | (m1 << 4));
+            out[outBytes++] = uint8_t(m1 >> 4);
+        }
+    }
+
+    return outBytes;
+}
+
+template <int MantBits>
+static size_t decodeBlockFloat(const uint8_t *in, const size_t numBytes, int16_t *out, const size_t numComps)
+{
+    const size_t inBytes = blockFloatBytes(numComps, MantBits);
+    if (inBytes > numBytes) return 0;
+
+    for (size_t i = 0; i < numComps; i += CODEC_BLOCK_SIZE)
+    {
+        const size_t n = std::min<size_t>(CODEC_BLOCK_SIZE, numComps-i);
+        int16_t *block = out+i;
+
+        const unsigned exp = *in++;
+        if (exp > 16-MantBits) return 0;
+        const int scale = 1 << exp;
+
+        if (MantBits == 8) for (size_t j = 0; j < n; j++)
+        {
+            block[j] = int16_t(int(int8_t(*in++))*scale);
+        }
+        else for (size_t j = 0; j < n; j += 2)
+        {
+            const uint16_t m0 = uint16_t(in[0] | ((in[1] & 0xf) << 8));
+            const uint16_t m1 = uint16_t((in[1] >> 4) | (in[2] << 4));
+            in += 3;
+            block[j+0] = int16_t((int16_t(m0 << 4) >> 4)*scale);
+            block[j+1] = int16_t((int16_t(m1 << 4) >> 4)*scale);
+        }
+    }
+
+    return inBytes;
+}
+
+/***********************************************************************
+ * Codec interface
+ **********************************************************************/
+static size_t codecComponentSize(const std::string &codec, const std::string &format)
+{
+    if (codec == "lossless" and format == SOAPY_SDR_CS16) return 2;
+    if (codec == "lossless" and format == SOAPY_SDR_CS8) return 1;
+    if (codec == "lossless" and format == SOAPY_SDR_CU8) return 1;
+    if (codec == "bfp8" and format == SOAPY_SDR_CS16) return 2;
+    if (codec == "bfp12" and format == SOAPY_SDR_CS16) return 2;
+    return 0;
+}
+
+bool SoapyStreamCodec::isSupported(const std::string &codec, const std::string &format)
+{
+    return codecComponentSize(codec, format) != 0;
+}
+
+SoapyStreamCodec::SoapyStreamCodec(const std::string &codec, const std::string &format):
+    _compSize(codecComponentSize(codec, format)),
+    _mantBits((codec == "bfp8")?8:((codec == "bfp12")?12:0))
+{
+    if (_compSize == 0) throw std::runtime_error(
+        "SoapyRemote::SoapyStreamCodec() "+codec+" compression not supported for format " + format);
+}
+
+size_t SoapyStreamCodec::fixedBytes(const size_t numElems) const
+{
+    return blockFloatBytes(numElems*2, _mantBits);
+}
+
+size_t SoapyStreamCodec::encode(const void *in, const size_t numElems, void *out, const size_t maxBytes) const
+{
+    if (_mantBits == 8) return encodeBlockFloat<8>((const int16_t *)in, numElems*2, (uint8_t *)out, maxBytes);
+    if (_mantBits == 12) return encodeBlockFloat<12>((const int16_t *)in, numElems*2, (uint8_t *)out, maxBytes);
+    if (_compSize == 2) return encodeComponents<uint16_t>((const uint16_t *)in, numElems*2, (uint8_t *)out, maxBytes);
+    return encodeComponents<uint8_t>((const uint8_t *)in, numElems*2, (uint8_t *)out, maxBytes);
+}
+
+size_t SoapyStreamCodec::decode(const void *in, const size_t numBytes, void *out, const size_t numElems) const
+{
+    if (_mantBits == 8) return decodeBlockFloat<8>((const uint8_t *)in, numBytes, (int16_t *)out, numElems*2);
+    if (_mantBits == 12) return decodeBlockFloat<12>((const uint8_t *)in, numBytes, (int16_t *)out, numElems*2);
+    if (_compSize == 2) return decodeComponents<uint16_t>((const uint8_t *)in, numBytes, (uint16_t *)out, numElems*2);
+    return decodeComponents<uint8_t>((const uint8_t *)in, numBytes, (uint8_t *)out, numElems*2);
+}
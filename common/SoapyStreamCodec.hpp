@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+/*!
+ * Codecs for the stream payload of integer formats.
+ *
+ * The "lossless" codec supports CS16, CS8, and CU8.
+ * Each I and Q component is delta coded against the previous
+ * component of the same kind, zigzag mapped to an unsigned value,
+ * and bit packed in blocks with one width byte per block.
+ * Quiet signals need only a few bits per component,
+ * and a full scale block costs one extra byte.
+ *
+ * The "bfp8" and "bfp12" block floating point codecs support CS16.
+ * Each block of components shares one exponent byte,
+ * and the components are rounded to 8 or 12 bit mantissas.
+ * The encoded size is fixed by the number of elements.
+ */
+class SoapyStreamCodec
+{
+public:
+
+    //! Is the codec supported for this stream format?
+    static bool isSupported(const std::string &codec, const std::string &format);
+
+    //! Create a codec for the stream format or throw
+    SoapyStreamCodec(const std::string &codec, const std::string &format);
+
+    //! Does decoding restore the exact samples?
+    bool isLossless(void) const
+    {
+        return _mantBits == 0;
+    }
+
+    //! Encoded bytes for one channel of a lossy codec
+    size_t fixedBytes(const size_t numElems) const;
+
+    /*!
+     * Encode one channel of elements into the output.
+     * \return the bytes written or 0 when it needs more than maxBytes
+     */
+    size_t encode(const void *in, const size_t numElems, void *out, const size_t maxBytes) const;
+
+    /*!
+     * Decode one channel of elements from the input.
+     * \return the bytes consumed or 0 when the input is malformed
+     */
+    size_t decode(const void *in, const size_t numBytes, void *out, const size_t numElems) const;
+
+private:
+    size_t _compSize; //bytes per I or Q component
+    size_t _mantBits; //block floating point mantissa, 0 when lossless
+};
@@ -0,0 +1,1604 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyStreamConvert.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <cstring> //memcpy
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <algorithm> //find
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CONVERT_HAS_X86
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#define TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CONVERT_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+/***********************************************************************
+ * Generic kernels:
+ * These are the reference implementations for all other kernels.
+ * The clamp is written to match the min/max instructions,
+ * a NaN input is clamped to the low limit.
+ **********************************************************************/
+template <typename T>
+static inline T clampValue(T x, const T lo, const T hi)
+{
+    x = (x > lo)?x:lo;
+    return (x < hi)?x:hi;
+}
+
+/*!
+ * Sample traits convert one real sample to and from the compute type.
+ * Integer samples saturate on the way out, CU8 samples carry an offset of 127.
+ */
+template <typename SampleType>
+struct SampleTraits
+{
+    template <typename ComputeType>
+    static inline ComputeType toValue(const SampleType x)
+    {
+        return ComputeType(int(x));
+    }
+
+    template <typename ComputeType>
+    static inline SampleType fromValue(const ComputeType x)
+    {
+        const ComputeType lo(std::numeric_limits<SampleType>::min());
+        const ComputeType hi(std::numeric_limits<SampleType>::max());
+        return SampleType(int(clampValue(x, lo, hi)));
+    }
+};
+
+template <>
+struct SampleTraits<uint8_t>
+{
+    template <typename ComputeType>
+    static inline ComputeType toValue(const uint8_t x)
+    {
+        return ComputeType(int(x)-127);
+    }
+
+    template <typename ComputeType>
+    static inline uint8_t fromValue(const ComputeType x)
+    {
+        return uint8_t(int(clampValue(x, ComputeType(-127), ComputeType(128))) + 127);
+    }
+};
+
+template <typename FloatType>
+struct FloatSampleTraits
+{
+    template <typename ComputeType>
+    static inline ComputeType toValue(const FloatType x)
+    {
+        return ComputeType(x);
+    }
+
+    template <typename ComputeType>
+    static inline FloatType fromValue(const ComputeType x)
+    {
+        return FloatType(x);
+    }
+};
+
+template <> struct SampleTraits<float> : FloatSampleTraits<float> {};
+template <> struct SampleTraits<double> : FloatSampleTraits<double> {};
+
+//! An IEEE half precision sample for the CF16 format
+struct HalfSample
+{
+    uint16_t bits;
+};
+
+static inline float halfToFloat(const uint16_t h)
+{
+    //move the exponent and mantissa into place and rebias the exponent
+    uint32_t x = uint32_t(h & 0x7fff) << 13;
+    const uint32_t exp = x & 0x0f800000;
+    x += (127-15) << 23;
+    if (exp == 0x0f800000) //infinity or nan, nan is made quiet
+    {
+        x += (128-16) << 23;
+        if ((h & 0x3ff) != 0) x |= 0x00400000;
+    }
+    else if (exp == 0) //zero or subnormal, renormalize with float arithmetic
+    {
+        x += 1 << 23;
+        float f; std::memcpy(&f, &x, sizeof(f));
+        f -= 6.103515625e-05f; //2^-14
+        std::memcpy(&x, &f, sizeof(x));
+    }
+    x |= uint32_t(h & 0x8000) << 16;
+    float f; std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline uint16_t floatToHalf(const float f)
+{
+    uint32_t x; std::memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = uint16_t((x >> 16) & 0x8000);
+    x &= 0x7fffffff;
+
+    //infinity or nan, nan keeps the upper mantissa bits and is made quiet
+    if (x >= 0x7f800000) return uint16_t(sign | 0x7c00 | ((x > 0x7f800000)?(0x200 | ((x >> 13) & 0x3ff)):0));
+
+    //overflow rounds to infinity
+    if (x >= 0x47800000) return uint16_t(sign | 0x7c00);
+
+    //subnormal or zero, align the mantissa with float addition to round to nearest even
+    if (x < 0x38800000)
+    {
+        float a; std::memcpy(&a, &x, sizeof(a));
+        a += 0.5f;
+        std::memcpy(&x, &a, sizeof(x));
+        return uint16_t(sign | (x - 0x3f000000));
+    }
+
+    //rebias the exponent and round the mantissa to nearest even
+    x += (uint32_t(15-127) << 23) + 0xfff + ((x >> 13) & 1);
+    return uint16_t(sign | (x >> 13));
+}
+
+/*!
+ * Half precision samples convert through single precision.
+ * Rounding is to nearest even and overflow goes to infinity,
+ * which matches the F16C and NEON conversion instructions.
+ */
+template <>
+struct SampleTraits<HalfSample>
+{
+    template <typename ComputeType>
+    static inline ComputeType toValue(const HalfSample x)
+    {
+        return ComputeType(halfToFloat(x.bits));
+    }
+
+    template <typename ComputeType>
+    static inline HalfSample fromValue(const ComputeType x)
+    {
+        return HalfSample{floatToHalf(float(x))};
+    }
+};
+
+//compute in double precision when either side is double precision
+template <typename InType, typename OutType>
+struct ComputeTypeOf
+{
+    typedef typename std::conditional<std::is_same<InType, double>::value or
+        std::is_same<OutType, double>::value, double, float>::type type;
+};
+
+/*!
+ * Scale from the remote format to the local format on receive, and back on send.
+ * The stream scale factor is the remote value of a full-scale local sample,
+ * where the local full scale is 1.0 for floats and LocalFullScale for integers.
+ */
+template <bool Recv, int LocalFullScale>
+static inline double convertScale(const double scaleFactor)
+{
+    return Recv?(LocalFullScale/scaleFactor):(scaleFactor/LocalFullScale);
+}
+
+//convert a buffer of complex elements one real sample at a time
+template <typename InType, typename OutType, bool Recv, int LocalFullScale = 1>
+static void convertSamples(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    typedef typename ComputeTypeOf<InType, OutType>::type ComputeType;
+    const ComputeType scale = ComputeType(convertScale<Recv, LocalFullScale>(scaleFactor));
+    auto in = (const InType *)in_;
+    auto out = (OutType *)out_;
+    for (size_t j = 0; j < numElems*2; j++)
+    {
+        const ComputeType x = SampleTraits<InType>::template toValue<ComputeType>(in[j]);
+        out[j] = SampleTraits<OutType>::template fromValue<ComputeType>(x*scale);
+    }
+}
+
+//note that we correct the scale for the CS16 intermediate step
+template <typename FloatType>
+static void CS12toFloat(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const FloatType scale = FloatType(1.0/16.0/scaleFactor);
+    auto in = (const uint8_t *)in_;
+    auto out = (FloatType *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        uint16_t part0 = uint16_t(*(in++));
+        uint16_t part1 = uint16_t(*(in++));
+        uint16_t part2 = uint16_t(*(in++));
+        int16_t i = int16_t((part1 << 12) | (part0 << 4));
+        int16_t q = int16_t((part2 << 8) | (part1 & 0xf0));
+        *(out++) = FloatType(i)*scale;
+        *(out++) = FloatType(q)*scale;
+    }
+}
+
+template <typename FloatType>
+static void floatToCS12(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const FloatType scale = FloatType(16.0*scaleFactor);
+    auto in = (const FloatType *)in_;
+    auto out = (uint8_t *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        uint16_t i = uint16_t(SampleTraits<int16_t>::fromValue<FloatType>(*(in++)*scale));
+        uint16_t q = uint16_t(SampleTraits<int16_t>::fromValue<FloatType>(*(in++)*scale));
+        *(out++) = uint8_t(i >> 4);
+        *(out++) = uint8_t((q & 0xf0)|(i >> 12));
+        *(out++) = uint8_t(q >> 8);
+    }
+}
+
+/*!
+ * CS4 packs each element into one byte: the I component in the low nibble,
+ * and the Q component in the high nibble, both in two's complement.
+ * The local full scale applies to integer local formats such as CS16 and CS8,
+ * and to CS4 itself when CS4 is the local format of a converted stream.
+ */
+template <typename OutType, bool Recv, int LocalFullScale = 1>
+static void CS4toSamples(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    typedef typename ComputeTypeOf<int8_t, OutType>::type ComputeType;
+    const ComputeType scale = ComputeType(convertScale<Recv, LocalFullScale>(scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (OutType *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        const int i = int8_t(in[j] << 4) >> 4;
+        const int q = int8_t(in[j]) >> 4;
+        *(out++) = SampleTraits<OutType>::template fromValue<ComputeType>(ComputeType(i)*scale);
+        *(out++) = SampleTraits<OutType>::template fromValue<ComputeType>(ComputeType(q)*scale);
+    }
+}
+
+template <typename InType, bool Recv, int LocalFullScale = 1>
+static void samplesToCS4(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    typedef typename ComputeTypeOf<InType, int8_t>::type ComputeType;
+    const ComputeType scale = ComputeType(convertScale<Recv, LocalFullScale>(scaleFactor));
+    auto in = (const InType *)in_;
+    auto out = (uint8_t *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        const ComputeType i = SampleTraits<InType>::template toValue<ComputeType>(*(in++))*scale;
+        const ComputeType q = SampleTraits<InType>::template toValue<ComputeType>(*(in++))*scale;
+        const int i4 = int(clampValue(i, ComputeType(-8), ComputeType(7)));
+        const int q4 = int(clampValue(q, ComputeType(-8), ComputeType(7)));
+        out[j] = uint8_t((i4 & 0xf) | ((q4 & 0xf) << 4));
+    }
+}
+
+//the generic kernels that the SIMD kernels fall back on for the tail
+static const ConvertFunction CS16toCF32_generic = convertSamples<int16_t, float, true>;
+static const ConvertFunction CF32toCS16_generic = convertSamples<float, int16_t, false>;
+static const ConvertFunction CS8toCF32_generic = convertSamples<int8_t, float, true>;
+static const ConvertFunction CF32toCS8_generic = convertSamples<float, int8_t, false>;
+static const ConvertFunction CU8toCF32_generic = convertSamples<uint8_t, float, true>;
+static const ConvertFunction CF32toCU8_generic = convertSamples<float, uint8_t, false>;
+static const ConvertFunction CS12toCF32_generic = CS12toFloat<float>;
+static const ConvertFunction CF32toCS12_generic = floatToCS12<float>;
+static const ConvertFunction CF16toCF32_generic = convertSamples<HalfSample, float, true>;
+static const ConvertFunction CF32toCF16_generic = convertSamples<float, HalfSample, false>;
+static const ConvertFunction CS4toCF32_generic = CS4toSamples<float, true>;
+static const ConvertFunction CF32toCS4_generic = samplesToCS4<float, false>;
+
+//the CS8 scale factors are expected to be powers of 2, usually 128
+static inline int recvScaleCS16CS8(const double scaleFactor)
+{
+    const int scale = int(scaleFactor);
+    return 32768/((scale < 1)?1:scale);
+}
+
+static inline int sendScaleCS16CS8(const double scaleFactor)
+{
+    const int scale = int(scaleFactor + 1)/128; //round e.g. 2047.0 and 32767.0
+    return (scale < 1)?1:scale;
+}
+
+//return the shift for a power of 2 scale or -1 otherwise
+static inline int scaleToShift(const int scale)
+{
+    for (int shift = 0; shift < 16; shift++)
+    {
+        if (scale == (1 << shift)) return shift;
+    }
+    return -1;
+}
+
+static void CS12toCS16_generic(const void *in_, void *out_, const size_t numElems, const double)
+{
+    auto in = (const uint8_t *)in_;
+    auto out = (int16_t *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        uint16_t part0 = uint16_t(*(in++));
+        uint16_t part1 = uint16_t(*(in++));
+        uint16_t part2 = uint16_t(*(in++));
+        *(out++) = int16_t((part1 << 12) | (part0 << 4));
+        *(out++) = int16_t((part2 << 8) | (part1 & 0xf0));
+    }
+}
+
+static void CS16toCS12_generic(const void *in_, void *out_, const size_t numElems, const double)
+{
+    auto in = (const int16_t *)in_;
+    auto out = (uint8_t *)out_;
+    for (size_t j = 0; j < numElems; j++)
+    {
+        uint16_t i = uint16_t(*(in++));
+        uint16_t q = uint16_t(*(in++));
+        *(out++) = uint8_t(i >> 4);
+        *(out++) = uint8_t((q & 0xf0)|(i >> 12));
+        *(out++) = uint8_t(q >> 8);
+    }
+}
+
+static void CS8toCS16_generic(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int scale = recvScaleCS16CS8(scaleFactor);
+    auto in = (const int8_t *)in_;
+    auto out = (int16_t *)out_;
+    for (size_t j = 0; j < numElems*2; j++)
+    {
+        out[j] = int16_t(int(in[j])*scale);
+    }
+}
+
+static void CS16toCS8_generic(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int scale = sendScaleCS16CS8(scaleFactor);
+    auto in = (const int16_t *)in_;
+    auto out = (int8_t *)out_;
+    for (size_t j = 0; j < numElems*2; j++)
+    {
+        const int x = int(in[j])/scale;
+        out[j] = int8_t((x < -128)?-128:((x > 127)?127:x));
+    }
+}
+
+/***********************************************************************
+ * SSE2 and SSSE3 kernels
+ **********************************************************************/
+#ifdef CONVERT_HAS_X86
+
+TARGET_SSE2 static inline __m128i sse2_loadClampCvt(const float *p, const __m128 scale, const __m128 lo, const __m128 hi)
+{
+    const __m128 x = _mm_mul_ps(_mm_loadu_ps(p), scale);
+    return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, lo), hi));
+}
+
+TARGET_SSE2 static inline void sse2_storeCvtScale(float *p, const __m128i x, const __m128 scale)
+{
+    _mm_storeu_ps(p, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+}
+
+TARGET_SSE2 static void CS16toCF32_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j));
+        sse2_storeCvtScale(out+j+0, _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), scale);
+        sse2_storeCvtScale(out+j+4, _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), scale);
+    }
+    CS16toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CF32toCS16_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(scaleFactor));
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const __m128i a = sse2_loadClampCvt(in+j+0, scale, lo, hi);
+        const __m128i b = sse2_loadClampCvt(in+j+4, scale, lo, hi);
+        _mm_storeu_si128((__m128i *)(out+j), _mm_packs_epi32(a, b));
+    }
+    CF32toCS16_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CS8toCS16_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128i scale = _mm_set1_epi16(int16_t(recvScaleCS16CS8(scaleFactor)));
+    auto in = (const int8_t *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j));
+        const __m128i a = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        const __m128i b = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        _mm_storeu_si128((__m128i *)(out+j+0), _mm_mullo_epi16(a, scale));
+        _mm_storeu_si128((__m128i *)(out+j+8), _mm_mullo_epi16(b, scale));
+    }
+    CS8toCS16_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+//truncating division by a power of 2: bias negative values before the shift
+TARGET_SSE2 static inline __m128i sse2_divPow2(const __m128i x, const __m128i bias, const int shift)
+{
+    const __m128i sign = _mm_srai_epi16(x, 15);
+    return _mm_sra_epi16(_mm_add_epi16(x, _mm_and_si128(sign, bias)), _mm_cvtsi32_si128(shift));
+}
+
+TARGET_SSE2 static void CS16toCS8_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int scale = sendScaleCS16CS8(scaleFactor);
+    const int shift = scaleToShift(scale);
+    if (shift < 0) return CS16toCS8_generic(in_, out_, numElems, scaleFactor);
+    const __m128i bias = _mm_set1_epi16(int16_t(scale-1));
+    auto in = (const int16_t *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i a = sse2_divPow2(_mm_loadu_si128((const __m128i *)(in+j+0)), bias, shift);
+        const __m128i b = sse2_divPow2(_mm_loadu_si128((const __m128i *)(in+j+8)), bias, shift);
+        _mm_storeu_si128((__m128i *)(out+j), _mm_packs_epi16(a, b));
+    }
+    CS16toCS8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CS8toCF32_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j));
+        const __m128i a = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        const __m128i b = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        sse2_storeCvtScale(out+j+0, _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16), scale);
+        sse2_storeCvtScale(out+j+4, _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16), scale);
+        sse2_storeCvtScale(out+j+8, _mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16), scale);
+        sse2_storeCvtScale(out+j+12, _mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16), scale);
+    }
+    CS8toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CF32toCS8_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(scaleFactor));
+    const __m128 lo = _mm_set1_ps(-128.0f);
+    const __m128 hi = _mm_set1_ps(127.0f);
+    auto in = (const float *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i a = sse2_loadClampCvt(in+j+0, scale, lo, hi);
+        const __m128i b = sse2_loadClampCvt(in+j+4, scale, lo, hi);
+        const __m128i c = sse2_loadClampCvt(in+j+8, scale, lo, hi);
+        const __m128i d = sse2_loadClampCvt(in+j+12, scale, lo, hi);
+        const __m128i r = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i *)(out+j), r);
+    }
+    CF32toCS8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CU8toCF32_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(1.0/scaleFactor));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi32(127);
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j));
+        const __m128i a = _mm_unpacklo_epi8(x, zero);
+        const __m128i b = _mm_unpackhi_epi8(x, zero);
+        sse2_storeCvtScale(out+j+0, _mm_sub_epi32(_mm_unpacklo_epi16(a, zero), offset), scale);
+        sse2_storeCvtScale(out+j+4, _mm_sub_epi32(_mm_unpackhi_epi16(a, zero), offset), scale);
+        sse2_storeCvtScale(out+j+8, _mm_sub_epi32(_mm_unpacklo_epi16(b, zero), offset), scale);
+        sse2_storeCvtScale(out+j+12, _mm_sub_epi32(_mm_unpackhi_epi16(b, zero), offset), scale);
+    }
+    CU8toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CF32toCU8_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(scaleFactor));
+    const __m128 lo = _mm_set1_ps(-127.0f);
+    const __m128 hi = _mm_set1_ps(128.0f);
+    const __m128i offset = _mm_set1_epi32(127);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i a = _mm_add_epi32(sse2_loadClampCvt(in+j+0, scale, lo, hi), offset);
+        const __m128i b = _mm_add_epi32(sse2_loadClampCvt(in+j+4, scale, lo, hi), offset);
+        const __m128i c = _mm_add_epi32(sse2_loadClampCvt(in+j+8, scale, lo, hi), offset);
+        const __m128i d = _mm_add_epi32(sse2_loadClampCvt(in+j+12, scale, lo, hi), offset);
+        const __m128i r = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i *)(out+j), r);
+    }
+    CF32toCU8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_SSE2 static void CS4toCF32_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(1.0/scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        //sign extend the low and high nibbles of each byte into words
+        const __m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(in+j/2)), _mm_setzero_si128());
+        const __m128i i = _mm_srai_epi16(_mm_slli_epi16(x, 12), 12);
+        const __m128i q = _mm_srai_epi16(_mm_slli_epi16(x, 8), 12);
+        const __m128i lo = _mm_unpacklo_epi16(i, q);
+        const __m128i hi = _mm_unpackhi_epi16(i, q);
+        sse2_storeCvtScale(out+j+0, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), scale);
+        sse2_storeCvtScale(out+j+4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), scale);
+        sse2_storeCvtScale(out+j+8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), scale);
+        sse2_storeCvtScale(out+j+12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), scale);
+    }
+    CS4toCF32_generic(in+j/2, out+j, (n-j)/2, scaleFactor);
+}
+
+//merge the I word and the Q word of each element into the nibbles of one byte
+TARGET_SSE2 static inline __m128i sse2_packCS4(const __m128i x)
+{
+    const __m128i i = _mm_and_si128(x, _mm_set1_epi32(0x0f));
+    const __m128i q = _mm_and_si128(_mm_srli_epi32(x, 12), _mm_set1_epi32(0xf0));
+    return _mm_or_si128(i, q);
+}
+
+TARGET_SSE2 static void CF32toCS4_sse2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(scaleFactor));
+    const __m128 lo = _mm_set1_ps(-8.0f);
+    const __m128 hi = _mm_set1_ps(7.0f);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m128i a = sse2_loadClampCvt(in+j+0, scale, lo, hi);
+        const __m128i b = sse2_loadClampCvt(in+j+4, scale, lo, hi);
+        const __m128i c = sse2_loadClampCvt(in+j+8, scale, lo, hi);
+        const __m128i d = sse2_loadClampCvt(in+j+12, scale, lo, hi);
+        const __m128i x = sse2_packCS4(_mm_packs_epi32(a, b));
+        const __m128i y = sse2_packCS4(_mm_packs_epi32(c, d));
+        const __m128i r = _mm_packs_epi32(x, y);
+        _mm_storel_epi64((__m128i *)(out+j/2), _mm_packus_epi16(r, r));
+    }
+    CF32toCS4_generic(in+j, out+j/2, (n-j)/2, scaleFactor);
+}
+
+//Unpack 4 CS12 elements from the first 12 bytes into 8 CS16 values:
+//shuffle byte pairs into words, then shift the I words and mask the Q words.
+TARGET_SSSE3 static inline __m128i ssse3_unpackCS12(const __m128i x)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+    const __m128i v = _mm_shuffle_epi8(x, shuffle);
+    const __m128i i = _mm_and_si128(_mm_slli_epi16(v, 4), _mm_set1_epi32(0x0000ffff));
+    const __m128i q = _mm_and_si128(v, _mm_set1_epi32(int(0xfff00000)));
+    return _mm_or_si128(i, q);
+}
+
+//Pack 8 CS16 values into 4 CS12 elements in the first 12 bytes:
+//combine the upper 12 bits of I and Q in each dword, then shuffle out the pad bytes.
+TARGET_SSSE3 static inline __m128i ssse3_packCS12(const __m128i x)
+{
+    const __m128i i = _mm_srli_epi32(_mm_slli_epi32(x, 16), 20);
+    const __m128i q = _mm_slli_epi32(_mm_srli_epi32(x, 20), 12);
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    return _mm_shuffle_epi8(_mm_or_si128(i, q), shuffle);
+}
+
+TARGET_SSSE3 static inline void ssse3_store12(uint8_t *out, const __m128i x)
+{
+    _mm_storel_epi64((__m128i *)out, x);
+    const int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(x, 8));
+    std::memcpy(out+8, &tail, sizeof(tail));
+}
+
+TARGET_SSSE3 static void CS12toCS16_ssse3(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const uint8_t *)in_;
+    auto out = (int16_t *)out_;
+    size_t j = 0;
+    for (; j + 6 <= numElems; j += 4) //the 16 byte load reads 2 elements ahead
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j*3));
+        _mm_storeu_si128((__m128i *)(out+j*2), ssse3_unpackCS12(x));
+    }
+    CS12toCS16_generic(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+TARGET_SSSE3 static void CS16toCS12_ssse3(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const int16_t *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 4 <= numElems; j += 4)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(in+j*2));
+        ssse3_store12(out+j*3, ssse3_packCS12(x));
+    }
+    CS16toCS12_generic(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+TARGET_SSSE3 static void CS12toCF32_ssse3(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(1.0/16.0/scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    size_t j = 0;
+    for (; j + 6 <= numElems; j += 4) //the 16 byte load reads 2 elements ahead
+    {
+        const __m128i x = ssse3_unpackCS12(_mm_loadu_si128((const __m128i *)(in+j*3)));
+        sse2_storeCvtScale(out+j*2+0, _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), scale);
+        sse2_storeCvtScale(out+j*2+4, _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), scale);
+    }
+    CS12toCF32_generic(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+TARGET_SSSE3 static void CF32toCS12_ssse3(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m128 scale = _mm_set1_ps(float(16.0*scaleFactor));
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 4 <= numElems; j += 4)
+    {
+        const __m128i a = sse2_loadClampCvt(in+j*2+0, scale, lo, hi);
+        const __m128i b = sse2_loadClampCvt(in+j*2+4, scale, lo, hi);
+        ssse3_store12(out+j*3, ssse3_packCS12(_mm_packs_epi32(a, b)));
+    }
+    CF32toCS12_generic(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+/***********************************************************************
+ * AVX2 kernels
+ **********************************************************************/
+TARGET_AVX2 static inline __m256i avx2_loadClampCvt(const float *p, const __m256 scale, const __m256 lo, const __m256 hi)
+{
+    const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(p), scale);
+    return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(x, lo), hi));
+}
+
+TARGET_AVX2 static inline void avx2_storeCvtScale(float *p, const __m256i x, const __m256 scale)
+{
+    _mm256_storeu_ps(p, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+}
+
+//the packs instructions work within 128-bit lanes, restore the order across lanes
+TARGET_AVX2 static inline __m256i avx2_packs32(const __m256i a, const __m256i b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+}
+
+TARGET_AVX2 static inline __m256i avx2_packs16(const __m256i a, const __m256i b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+}
+
+TARGET_AVX2 static inline __m256i avx2_packus16(const __m256i a, const __m256i b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+}
+
+TARGET_AVX2 static void CS16toCF32_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        avx2_storeCvtScale(out+j+0, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in+j+0))), scale);
+        avx2_storeCvtScale(out+j+8, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in+j+8))), scale);
+    }
+    CS16toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CF32toCS16_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(scaleFactor));
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m256i a = avx2_loadClampCvt(in+j+0, scale, lo, hi);
+        const __m256i b = avx2_loadClampCvt(in+j+8, scale, lo, hi);
+        _mm256_storeu_si256((__m256i *)(out+j), avx2_packs32(a, b));
+    }
+    CF32toCS16_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CS8toCS16_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256i scale = _mm256_set1_epi16(int16_t(recvScaleCS16CS8(scaleFactor)));
+    auto in = (const int8_t *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32)
+    {
+        const __m256i a = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(in+j+0)));
+        const __m256i b = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(in+j+16)));
+        _mm256_storeu_si256((__m256i *)(out+j+0), _mm256_mullo_epi16(a, scale));
+        _mm256_storeu_si256((__m256i *)(out+j+16), _mm256_mullo_epi16(b, scale));
+    }
+    CS8toCS16_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static inline __m256i avx2_divPow2(const __m256i x, const __m256i bias, const int shift)
+{
+    const __m256i sign = _mm256_srai_epi16(x, 15);
+    return _mm256_sra_epi16(_mm256_add_epi16(x, _mm256_and_si256(sign, bias)), _mm_cvtsi32_si128(shift));
+}
+
+TARGET_AVX2 static void CS16toCS8_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int scale = sendScaleCS16CS8(scaleFactor);
+    const int shift = scaleToShift(scale);
+    if (shift < 0) return CS16toCS8_generic(in_, out_, numElems, scaleFactor);
+    const __m256i bias = _mm256_set1_epi16(int16_t(scale-1));
+    auto in = (const int16_t *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32)
+    {
+        const __m256i a = avx2_divPow2(_mm256_loadu_si256((const __m256i *)(in+j+0)), bias, shift);
+        const __m256i b = avx2_divPow2(_mm256_loadu_si256((const __m256i *)(in+j+16)), bias, shift);
+        _mm256_storeu_si256((__m256i *)(out+j), avx2_packs16(a, b));
+    }
+    CS16toCS8_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CS8toCF32_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        avx2_storeCvtScale(out+j+0, _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(in+j+0))), scale);
+        avx2_storeCvtScale(out+j+8, _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(in+j+8))), scale);
+    }
+    CS8toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CF32toCS8_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(scaleFactor));
+    const __m256 lo = _mm256_set1_ps(-128.0f);
+    const __m256 hi = _mm256_set1_ps(127.0f);
+    auto in = (const float *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32)
+    {
+        const __m256i a = avx2_loadClampCvt(in+j+0, scale, lo, hi);
+        const __m256i b = avx2_loadClampCvt(in+j+8, scale, lo, hi);
+        const __m256i c = avx2_loadClampCvt(in+j+16, scale, lo, hi);
+        const __m256i d = avx2_loadClampCvt(in+j+24, scale, lo, hi);
+        _mm256_storeu_si256((__m256i *)(out+j), avx2_packs16(avx2_packs32(a, b), avx2_packs32(c, d)));
+    }
+    CF32toCS8_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CU8toCF32_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(1.0/scaleFactor));
+    const __m256i offset = _mm256_set1_epi32(127);
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(in+j+0)));
+        const __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(in+j+8)));
+        avx2_storeCvtScale(out+j+0, _mm256_sub_epi32(a, offset), scale);
+        avx2_storeCvtScale(out+j+8, _mm256_sub_epi32(b, offset), scale);
+    }
+    CU8toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX2 static void CF32toCU8_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(scaleFactor));
+    const __m256 lo = _mm256_set1_ps(-127.0f);
+    const __m256 hi = _mm256_set1_ps(128.0f);
+    const __m256i offset = _mm256_set1_epi32(127);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32)
+    {
+        const __m256i a = _mm256_add_epi32(avx2_loadClampCvt(in+j+0, scale, lo, hi), offset);
+        const __m256i b = _mm256_add_epi32(avx2_loadClampCvt(in+j+8, scale, lo, hi), offset);
+        const __m256i c = _mm256_add_epi32(avx2_loadClampCvt(in+j+16, scale, lo, hi), offset);
+        const __m256i d = _mm256_add_epi32(avx2_loadClampCvt(in+j+24, scale, lo, hi), offset);
+        _mm256_storeu_si256((__m256i *)(out+j), avx2_packus16(avx2_packs32(a, b), avx2_packs32(c, d)));
+    }
+    CF32toCU8_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+//Load 8 CS12 elements as 4 elements per 128-bit lane,
+//the second 16 byte load reads 2 elements ahead.
+TARGET_AVX2 static inline __m256i avx2_unpackCS12(const uint8_t *in)
+{
+    const __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(
+        _mm_loadu_si128((const __m128i *)(in+0))),
+        _mm_loadu_si128((const __m128i *)(in+12)), 1);
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+        0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+    const __m256i v = _mm256_shuffle_epi8(x, shuffle);
+    const __m256i i = _mm256_and_si256(_mm256_slli_epi16(v, 4), _mm256_set1_epi32(0x0000ffff));
+    const __m256i q = _mm256_and_si256(v, _mm256_set1_epi32(int(0xfff00000)));
+    return _mm256_or_si256(i, q);
+}
+
+//Pack 8 elements into 12 bytes at the start of each 128-bit lane and store 24 bytes.
+TARGET_AVX2 static inline void avx2_packStoreCS12(uint8_t *out, const __m256i x)
+{
+    const __m256i i = _mm256_srli_epi32(_mm256_slli_epi32(x, 16), 20);
+    const __m256i q = _mm256_slli_epi32(_mm256_srli_epi32(x, 20), 12);
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i v = _mm256_shuffle_epi8(_mm256_or_si256(i, q), shuffle);
+    ssse3_store12(out+0, _mm256_castsi256_si128(v));
+    ssse3_store12(out+12, _mm256_extracti128_si256(v, 1));
+}
+
+TARGET_AVX2 static void CS12toCS16_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const uint8_t *)in_;
+    auto out = (int16_t *)out_;
+    size_t j = 0;
+    for (; j + 10 <= numElems; j += 8)
+    {
+        _mm256_storeu_si256((__m256i *)(out+j*2), avx2_unpackCS12(in+j*3));
+    }
+    CS12toCS16_ssse3(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+TARGET_AVX2 static void CS16toCS12_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const int16_t *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        avx2_packStoreCS12(out+j*3, _mm256_loadu_si256((const __m256i *)(in+j*2)));
+    }
+    CS16toCS12_ssse3(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+TARGET_AVX2 static void CS12toCF32_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(1.0/16.0/scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    size_t j = 0;
+    for (; j + 10 <= numElems; j += 8)
+    {
+        const __m256i x = avx2_unpackCS12(in+j*3);
+        avx2_storeCvtScale(out+j*2+0, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)), scale);
+        avx2_storeCvtScale(out+j*2+8, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)), scale);
+    }
+    CS12toCF32_ssse3(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+TARGET_AVX2 static void CF32toCS12_avx2(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(16.0*scaleFactor));
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        const __m256i a = avx2_loadClampCvt(in+j*2+0, scale, lo, hi);
+        const __m256i b = avx2_loadClampCvt(in+j*2+8, scale, lo, hi);
+        avx2_packStoreCS12(out+j*3, avx2_packs32(a, b));
+    }
+    CF32toCS12_ssse3(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+/***********************************************************************
+ * AVX-512 kernels: the saturating down conversions
+ * replace the pack sequences for the float formats
+ **********************************************************************/
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+//false positive on the undefined vectors in gcc's avx512fintrin.h
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+TARGET_AVX512 static inline __m512i avx512_loadClampCvt(const float *p, const __m512 scale, const __m512 lo, const __m512 hi)
+{
+    const __m512 x = _mm512_mul_ps(_mm512_loadu_ps(p), scale);
+    return _mm512_cvttps_epi32(_mm512_min_ps(_mm512_max_ps(x, lo), hi));
+}
+
+TARGET_AVX512 static inline void avx512_storeCvtScale(float *p, const __m512i x, const __m512 scale)
+{
+    _mm512_storeu_ps(p, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+}
+
+TARGET_AVX512 static void CS16toCF32_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        avx512_storeCvtScale(out+j, _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(in+j))), scale);
+    }
+    CS16toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX512 static void CF32toCS16_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(scaleFactor));
+    const __m512 lo = _mm512_set1_ps(-32768.0f);
+    const __m512 hi = _mm512_set1_ps(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m512i x = avx512_loadClampCvt(in+j, scale, lo, hi);
+        _mm256_storeu_si256((__m256i *)(out+j), _mm512_cvtsepi32_epi16(x));
+    }
+    CF32toCS16_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX512 static void CS8toCF32_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(1.0/scaleFactor));
+    auto in = (const int8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        avx512_storeCvtScale(out+j, _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i *)(in+j))), scale);
+    }
+    CS8toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX512 static void CF32toCS8_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(scaleFactor));
+    const __m512 lo = _mm512_set1_ps(-128.0f);
+    const __m512 hi = _mm512_set1_ps(127.0f);
+    auto in = (const float *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m512i x = avx512_loadClampCvt(in+j, scale, lo, hi);
+        _mm_storeu_si128((__m128i *)(out+j), _mm512_cvtsepi32_epi8(x));
+    }
+    CF32toCS8_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX512 static void CU8toCF32_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(1.0/scaleFactor));
+    const __m512i offset = _mm512_set1_epi32(127);
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m512i x = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(in+j)));
+        avx512_storeCvtScale(out+j, _mm512_sub_epi32(x, offset), scale);
+    }
+    CU8toCF32_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+TARGET_AVX512 static void CF32toCU8_avx512(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m512 scale = _mm512_set1_ps(float(scaleFactor));
+    const __m512 lo = _mm512_set1_ps(-127.0f);
+    const __m512 hi = _mm512_set1_ps(128.0f);
+    const __m512i offset = _mm512_set1_epi32(127);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const __m512i x = _mm512_add_epi32(avx512_loadClampCvt(in+j, scale, lo, hi), offset);
+        _mm_storeu_si128((__m128i *)(out+j), _mm512_cvtusepi32_epi8(x));
+    }
+    CF32toCU8_sse2(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/***********************************************************************
+ * F16C kernels:
+ * The Recv parameter selects the scale direction,
+ * so the same kernel serves CF16 as the local or the remote format.
+ **********************************************************************/
+template <bool Recv>
+TARGET_F16C static void CF16toCF32_f16c(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(convertScale<Recv, 1>(scaleFactor)));
+    auto in = (const uint16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const __m256 x = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(in+j)));
+        _mm256_storeu_ps(out+j, _mm256_mul_ps(x, scale));
+    }
+    convertSamples<HalfSample, float, Recv>(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+template <bool Recv>
+TARGET_F16C static void CF32toCF16_f16c(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const __m256 scale = _mm256_set1_ps(float(convertScale<Recv, 1>(scaleFactor)));
+    auto in = (const float *)in_;
+    auto out = (uint16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(in+j), scale);
+        _mm_storeu_si128((__m128i *)(out+j), _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT));
+    }
+    convertSamples<float, HalfSample, Recv>(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+#endif //CONVERT_HAS_X86
+
+/***********************************************************************
+ * NEON kernels
+ **********************************************************************/
+#ifdef CONVERT_HAS_NEON
+
+//compare and select to match the generic clamp for NaN inputs
+static inline int32x4_t neon_loadClampCvt(const float *p, const float32x4_t scale, const float32x4_t lo, const float32x4_t hi)
+{
+    float32x4_t x = vmulq_f32(vld1q_f32(p), scale);
+    x = vbslq_f32(vcgtq_f32(x, lo), x, lo);
+    x = vbslq_f32(vcltq_f32(x, hi), x, hi);
+    return vcvtq_s32_f32(x);
+}
+
+static inline void neon_storeCvtScale(float *p, const int32x4_t x, const float32x4_t scale)
+{
+    vst1q_f32(p, vmulq_f32(vcvtq_f32_s32(x), scale));
+}
+
+static void CS16toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(1.0/scaleFactor));
+    auto in = (const int16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int16x8_t x = vld1q_s16(in+j);
+        neon_storeCvtScale(out+j+0, vmovl_s16(vget_low_s16(x)), scale);
+        neon_storeCvtScale(out+j+4, vmovl_s16(vget_high_s16(x)), scale);
+    }
+    CS16toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CF32toCS16_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(scaleFactor));
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int32x4_t a = neon_loadClampCvt(in+j+0, scale, lo, hi);
+        const int32x4_t b = neon_loadClampCvt(in+j+4, scale, lo, hi);
+        vst1q_s16(out+j, vcombine_s16(vmovn_s32(a), vmovn_s32(b)));
+    }
+    CF32toCS16_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CS8toCS16_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int16x8_t scale = vdupq_n_s16(int16_t(recvScaleCS16CS8(scaleFactor)));
+    auto in = (const int8_t *)in_;
+    auto out = (int16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const int8x16_t x = vld1q_s8(in+j);
+        vst1q_s16(out+j+0, vmulq_s16(vmovl_s8(vget_low_s8(x)), scale));
+        vst1q_s16(out+j+8, vmulq_s16(vmovl_s8(vget_high_s8(x)), scale));
+    }
+    CS8toCS16_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static inline int16x8_t neon_divPow2(const int16x8_t x, const int16x8_t bias, const int16x8_t shift)
+{
+    const int16x8_t sign = vshrq_n_s16(x, 15);
+    return vshlq_s16(vaddq_s16(x, vandq_s16(sign, bias)), shift);
+}
+
+static void CS16toCS8_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const int scale = sendScaleCS16CS8(scaleFactor);
+    const int shift = scaleToShift(scale);
+    if (shift < 0) return CS16toCS8_generic(in_, out_, numElems, scaleFactor);
+    const int16x8_t bias = vdupq_n_s16(int16_t(scale-1));
+    const int16x8_t rshift = vdupq_n_s16(int16_t(-shift));
+    auto in = (const int16_t *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const int16x8_t a = neon_divPow2(vld1q_s16(in+j+0), bias, rshift);
+        const int16x8_t b = neon_divPow2(vld1q_s16(in+j+8), bias, rshift);
+        vst1q_s8(out+j, vcombine_s8(vqmovn_s16(a), vqmovn_s16(b)));
+    }
+    CS16toCS8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CS8toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(1.0/scaleFactor));
+    auto in = (const int8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int16x8_t x = vmovl_s8(vld1_s8(in+j));
+        neon_storeCvtScale(out+j+0, vmovl_s16(vget_low_s16(x)), scale);
+        neon_storeCvtScale(out+j+4, vmovl_s16(vget_high_s16(x)), scale);
+    }
+    CS8toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CF32toCS8_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(scaleFactor));
+    const float32x4_t lo = vdupq_n_f32(-128.0f);
+    const float32x4_t hi = vdupq_n_f32(127.0f);
+    auto in = (const float *)in_;
+    auto out = (int8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int32x4_t a = neon_loadClampCvt(in+j+0, scale, lo, hi);
+        const int32x4_t b = neon_loadClampCvt(in+j+4, scale, lo, hi);
+        vst1_s8(out+j, vmovn_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b))));
+    }
+    CF32toCS8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CU8toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(1.0/scaleFactor));
+    const int16x8_t offset = vdupq_n_s16(127);
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int16x8_t x = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(in+j))), offset);
+        neon_storeCvtScale(out+j+0, vmovl_s16(vget_low_s16(x)), scale);
+        neon_storeCvtScale(out+j+4, vmovl_s16(vget_high_s16(x)), scale);
+    }
+    CU8toCF32_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CF32toCU8_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(scaleFactor));
+    const float32x4_t lo = vdupq_n_f32(-127.0f);
+    const float32x4_t hi = vdupq_n_f32(128.0f);
+    const int16x8_t offset = vdupq_n_s16(127);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        const int32x4_t a = neon_loadClampCvt(in+j+0, scale, lo, hi);
+        const int32x4_t b = neon_loadClampCvt(in+j+4, scale, lo, hi);
+        const int16x8_t x = vaddq_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b)), offset);
+        vst1_u8(out+j, vmovn_u16(vreinterpretq_u16_s16(x)));
+    }
+    CF32toCU8_generic(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CS4toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(1.0/scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const int8x8_t b = vreinterpret_s8_u8(vld1_u8(in+j/2));
+        const int8x8x2_t iq = vzip_s8(vshr_n_s8(vshl_n_s8(b, 4), 4), vshr_n_s8(b, 4));
+        const int16x8_t x = vmovl_s8(iq.val[0]);
+        const int16x8_t y = vmovl_s8(iq.val[1]);
+        neon_storeCvtScale(out+j+0, vmovl_s16(vget_low_s16(x)), scale);
+        neon_storeCvtScale(out+j+4, vmovl_s16(vget_high_s16(x)), scale);
+        neon_storeCvtScale(out+j+8, vmovl_s16(vget_low_s16(y)), scale);
+        neon_storeCvtScale(out+j+12, vmovl_s16(vget_high_s16(y)), scale);
+    }
+    CS4toCF32_generic(in+j/2, out+j, (n-j)/2, scaleFactor);
+}
+
+static void CF32toCS4_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(scaleFactor));
+    const float32x4_t lo = vdupq_n_f32(-8.0f);
+    const float32x4_t hi = vdupq_n_f32(7.0f);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16)
+    {
+        const int32x4_t a = neon_loadClampCvt(in+j+0, scale, lo, hi);
+        const int32x4_t b = neon_loadClampCvt(in+j+4, scale, lo, hi);
+        const int32x4_t c = neon_loadClampCvt(in+j+8, scale, lo, hi);
+        const int32x4_t d = neon_loadClampCvt(in+j+12, scale, lo, hi);
+        const int16x8x2_t iq = vuzpq_s16(vcombine_s16(vmovn_s32(a), vmovn_s32(b)), vcombine_s16(vmovn_s32(c), vmovn_s32(d)));
+        const uint8x8_t i = vand_u8(vreinterpret_u8_s8(vmovn_s16(iq.val[0])), vdup_n_u8(0x0f));
+        const uint8x8_t q = vshl_n_u8(vreinterpret_u8_s8(vmovn_s16(iq.val[1])), 4);
+        vst1_u8(out+j/2, vorr_u8(i, q));
+    }
+    CF32toCS4_generic(in+j, out+j/2, (n-j)/2, scaleFactor);
+}
+
+//unpack the deinterleaved CS12 bytes into I and Q
+static inline void neon_unpackCS12(const uint8x8_t b0, const uint8x8_t b1, const uint8x8_t b2, int16x8_t &i, int16x8_t &q)
+{
+    const uint16x8_t w0 = vmovl_u8(b0);
+    const uint16x8_t w1 = vmovl_u8(b1);
+    const uint16x8_t w2 = vmovl_u8(b2);
+    i = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(w1, 12), vshlq_n_u16(w0, 4)));
+    q = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(w2, 8), vandq_u16(w1, vdupq_n_u16(0xf0))));
+}
+
+//pack I and Q into deinterleaved CS12 bytes
+static inline uint8x8x3_t neon_packCS12(const int16x8_t i_, const int16x8_t q_)
+{
+    const uint16x8_t i = vreinterpretq_u16_s16(i_);
+    const uint16x8_t q = vreinterpretq_u16_s16(q_);
+    uint8x8x3_t b;
+    b.val[0] = vmovn_u16(vshrq_n_u16(i, 4));
+    b.val[1] = vmovn_u16(vorrq_u16(vandq_u16(q, vdupq_n_u16(0xf0)), vshrq_n_u16(i, 12)));
+    b.val[2] = vmovn_u16(vshrq_n_u16(q, 8));
+    return b;
+}
+
+static void CS12toCS16_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const uint8_t *)in_;
+    auto out = (int16_t *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        const uint8x8x3_t b = vld3_u8(in+j*3);
+        int16x8x2_t x;
+        neon_unpackCS12(b.val[0], b.val[1], b.val[2], x.val[0], x.val[1]);
+        vst2q_s16(out+j*2, x);
+    }
+    CS12toCS16_generic(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+static void CS16toCS12_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    auto in = (const int16_t *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        const int16x8x2_t x = vld2q_s16(in+j*2);
+        vst3_u8(out+j*3, neon_packCS12(x.val[0], x.val[1]));
+    }
+    CS16toCS12_generic(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+static void CS12toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(1.0/16.0/scaleFactor));
+    auto in = (const uint8_t *)in_;
+    auto out = (float *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        const uint8x8x3_t b = vld3_u8(in+j*3);
+        int16x8_t i, q;
+        neon_unpackCS12(b.val[0], b.val[1], b.val[2], i, q);
+        float32x4x2_t lo, hi;
+        lo.val[0] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(i))), scale);
+        lo.val[1] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(q))), scale);
+        hi.val[0] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(i))), scale);
+        hi.val[1] = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(q))), scale);
+        vst2q_f32(out+j*2+0, lo);
+        vst2q_f32(out+j*2+8, hi);
+    }
+    CS12toCF32_generic(in+j*3, out+j*2, numElems-j, scaleFactor);
+}
+
+static void CF32toCS12_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(16.0*scaleFactor));
+    const float32x4_t lo = vdupq_n_f32(-32768.0f);
+    const float32x4_t hi = vdupq_n_f32(32767.0f);
+    auto in = (const float *)in_;
+    auto out = (uint8_t *)out_;
+    size_t j = 0;
+    for (; j + 8 <= numElems; j += 8)
+    {
+        const int16x8_t x0 = vcombine_s16(
+            vmovn_s32(neon_loadClampCvt(in+j*2+0, scale, lo, hi)),
+            vmovn_s32(neon_loadClampCvt(in+j*2+4, scale, lo, hi)));
+        const int16x8_t x1 = vcombine_s16(
+            vmovn_s32(neon_loadClampCvt(in+j*2+8, scale, lo, hi)),
+            vmovn_s32(neon_loadClampCvt(in+j*2+12, scale, lo, hi)));
+        const int16x8x2_t x = vuzpq_s16(x0, x1); //I and Q
+        vst3_u8(out+j*3, neon_packCS12(x.val[0], x.val[1]));
+    }
+    CF32toCS12_generic(in+j*2, out+j*3, numElems-j, scaleFactor);
+}
+
+/***********************************************************************
+ * NEON half precision kernels (AArch64 always has the conversions)
+ **********************************************************************/
+#ifdef __aarch64__
+
+template <bool Recv>
+static void CF16toCF32_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(convertScale<Recv, 1>(scaleFactor)));
+    auto in = (const uint16_t *)in_;
+    auto out = (float *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+        const float32x4_t x = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in+j)));
+        vst1q_f32(out+j, vmulq_f32(x, scale));
+    }
+    convertSamples<HalfSample, float, Recv>(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+template <bool Recv>
+static void CF32toCF16_neon(const void *in_, void *out_, const size_t numElems, const double scaleFactor)
+{
+    const float32x4_t scale = vdupq_n_f32(float(convertScale<Recv, 1>(scaleFactor)));
+    auto in = (const float *)in_;
+    auto out = (uint16_t *)out_;
+    const size_t n = numElems*2;
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+        const float32x4_t x = vmulq_f32(vld1q_f32(in+j), scale);
+        vst1_u16(out+j, vreinterpret_u16_f16(vcvt_f16_f32(x)));
+    }
+    convertSamples<float, HalfSample, Recv>(in+j, out+j, (n-j)/2, scaleFactor);
+}
+
+#endif //__aarch64__
+
+#endif //CONVERT_HAS_NEON
+
+/***********************************************************************
+ * Converter registry with runtime kernel selection
+ **********************************************************************/
+//register a conversion or replace the kernels of a registered conversion
+static void setKernel(std::vector<ConvertKernel> &kernels,
+    const std::string &localFormat, const std::string &remoteFormat,
+    const ConvertFunction recv, const ConvertFunction send, const char *isa)
+{
+    for (auto &kernel : kernels)
+    {
+        if (kernel.localFormat != localFormat or kernel.remoteFormat != remoteFormat) continue;
+        kernel.recv = recv;
+        kernel.send = send;
+        kernel.isa = isa;
+        return;
+    }
+    ConvertKernel kernel;
+    kernel.localFormat = localFormat;
+    kernel.remoteFormat = remoteFormat;
+    kernel.recv = recv;
+    kernel.send = send;
+    kernel.isa = isa;
+    kernels.push_back(kernel);
+}
+
+static std::vector<ConvertKernel> registerConvertKernels(void)
+{
+    std::vector<ConvertKernel> kernels;
+
+    //the registration order is the order that local formats are advertised
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS16, CS16toCF32_generic, CF32toCS16_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS12, CS12toCF32_generic, CF32toCS12_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS8, CS8toCF32_generic, CF32toCS8_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CU8, CU8toCF32_generic, CF32toCU8_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CF64, convertSamples<double, float, true>, convertSamples<float, double, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_REMOTE_CF16, CF16toCF32_generic, CF32toCF16_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS4, CS4toCF32_generic, CF32toCS4_generic, "generic");
+
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CF32, convertSamples<float, double, true>, convertSamples<double, float, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CS16, convertSamples<int16_t, double, true>, convertSamples<double, int16_t, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CS12, CS12toFloat<double>, floatToCS12<double>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CS8, convertSamples<int8_t, double, true>, convertSamples<double, int8_t, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CU8, convertSamples<uint8_t, double, true>, convertSamples<double, uint8_t, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_REMOTE_CF16, convertSamples<HalfSample, double, true>, convertSamples<double, HalfSample, false>, "generic");
+    setKernel(kernels, SOAPY_SDR_CF64, SOAPY_SDR_CS4, CS4toSamples<double, true>, samplesToCS4<double, false>, "generic");
+
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS12, CS12toCS16_generic, CS16toCS12_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS8, CS8toCS16_generic, CS16toCS8_generic, "generic");
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CF32, convertSamples<float, int16_t, true, 32768>, convertSamples<int16_t, float, false, 32768>, "generic");
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS4, CS4toSamples<int16_t, true, 32768>, samplesToCS4<int16_t, false, 32768>, "generic");
+
+    setKernel(kernels, SOAPY_SDR_CS8, SOAPY_SDR_CU8, convertSamples<uint8_t, int8_t, true, 128>, convertSamples<int8_t, uint8_t, false, 128>, "generic");
+    setKernel(kernels, SOAPY_SDR_CS8, SOAPY_SDR_CS4, CS4toSamples<int8_t, true, 128>, samplesToCS4<int8_t, false, 128>, "generic");
+    setKernel(kernels, SOAPY_SDR_CU8, SOAPY_SDR_CS8, convertSamples<int8_t, uint8_t, true, 128>, convertSamples<uint8_t, int8_t, false, 128>, "generic");
+
+    setKernel(kernels, SOAPY_REMOTE_CF16, SOAPY_SDR_CS16, convertSamples<int16_t, HalfSample, true>, convertSamples<HalfSample, int16_t, false>, "generic");
+    setKernel(kernels, SOAPY_REMOTE_CF16, SOAPY_SDR_CF32, convertSamples<float, HalfSample, true>, convertSamples<HalfSample, float, false>, "generic");
+
+    setKernel(kernels, SOAPY_SDR_CS4, SOAPY_SDR_CS16, samplesToCS4<int16_t, true, 8>, CS4toSamples<int16_t, false, 8>, "generic");
+    setKernel(kernels, SOAPY_SDR_CS4, SOAPY_SDR_CS8, samplesToCS4<int8_t, true, 8>, CS4toSamples<int8_t, false, 8>, "generic");
+    setKernel(kernels, SOAPY_SDR_CS4, SOAPY_SDR_CF32, samplesToCS4<float, true, 8>, CS4toSamples<float, false, 8>, "generic");
+
+    //each instruction set replaces the kernels that it implements
+    #ifdef CONVERT_HAS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS16, CS16toCF32_sse2, CF32toCS16_sse2, "sse2");
+        setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS8, CS8toCS16_sse2, CS16toCS8_sse2, "sse2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS8, CS8toCF32_sse2, CF32toCS8_sse2, "sse2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CU8, CU8toCF32_sse2, CF32toCU8_sse2, "sse2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS4, CS4toCF32_sse2, CF32toCS4_sse2, "sse2");
+    }
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS12, CS12toCF32_ssse3, CF32toCS12_ssse3, "ssse3");
+        setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS12, CS12toCS16_ssse3, CS16toCS12_ssse3, "ssse3");
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS16, CS16toCF32_avx2, CF32toCS16_avx2, "avx2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS12, CS12toCF32_avx2, CF32toCS12_avx2, "avx2");
+        setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS12, CS12toCS16_avx2, CS16toCS12_avx2, "avx2");
+        setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS8, CS8toCS16_avx2, CS16toCS8_avx2, "avx2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS8, CS8toCF32_avx2, CF32toCS8_avx2, "avx2");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CU8, CU8toCF32_avx2, CF32toCU8_avx2, "avx2");
+    }
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS16, CS16toCF32_avx512, CF32toCS16_avx512, "avx512f");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS8, CS8toCF32_avx512, CF32toCS8_avx512, "avx512f");
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CU8, CU8toCF32_avx512, CF32toCU8_avx512, "avx512f");
+    }
+    if (__builtin_cpu_supports("avx") and __builtin_cpu_supports("f16c"))
+    {
+        setKernel(kernels, SOAPY_SDR_CF32, SOAPY_REMOTE_CF16, CF16toCF32_f16c<true>, CF32toCF16_f16c<false>, "f16c");
+        setKernel(kernels, SOAPY_REMOTE_CF16, SOAPY_SDR_CF32, CF32toCF16_f16c<true>, CF16toCF32_f16c<false>, "f16c");
+    }
+    #endif //CONVERT_HAS_X86
+
+    #ifdef CONVERT_HAS_NEON
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS16, CS16toCF32_neon, CF32toCS16_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS12, CS12toCF32_neon, CF32toCS12_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS12, CS12toCS16_neon, CS16toCS12_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CS16, SOAPY_SDR_CS8, CS8toCS16_neon, CS16toCS8_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS8, CS8toCF32_neon, CF32toCS8_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CU8, CU8toCF32_neon, CF32toCU8_neon, "neon");
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_SDR_CS4, CS4toCF32_neon, CF32toCS4_neon, "neon");
+    #ifdef __aarch64__
+    setKernel(kernels, SOAPY_SDR_CF32, SOAPY_REMOTE_CF16, CF16toCF32_neon<true>, CF32toCF16_neon<false>, "neon");
+    setKernel(kernels, SOAPY_REMOTE_CF16, SOAPY_SDR_CF32, CF32toCF16_neon<true>, CF16toCF32_neon<false>, "neon");
+    #endif //__aarch64__
+    #endif //CONVERT_HAS_NEON
+
+    return kernels;
+}
+
+static const std::vector<ConvertKernel> &getConvertKernels(void)
+{
+    static const std::vector<ConvertKernel> kernels(registerConvertKernels());
+    return kernels;
+}
+
+const ConvertKernel *findConvertKernel(const std::string &localFormat, const std::string &remoteFormat)
+{
+    //the shared copy entry has empty format names
+    static const ConvertKernel memcpyKernel{"", "", nullptr, nullptr, "memcpy"};
+    if (localFormat == remoteFormat) return &memcpyKernel;
+
+    for (const auto &kernel : getConvertKernels())
+    {
+        if (kernel.localFormat == localFormat and kernel.remoteFormat == remoteFormat) return &kernel;
+    }
+    return nullptr;
+}
+
+std::vector<std::string> getConvertLocalFormats(const std::vector<std::string> &remoteFormats)
+{
+    auto formats = remoteFormats;
+    for (const auto &kernel : getConvertKernels())
+    {
+        if (std::find(remoteFormats.begin(), remoteFormats.end(), kernel.remoteFormat) == remoteFormats.end()) continue;
+        if (std::find(formats.begin(), formats.end(), kernel.localFormat) != formats.end()) continue;
+        formats.push_back(kernel.localFormat);
+    }
+    return formats;
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//! Complex IEEE half precision floats, a remote format not named by SoapySDR
+#define SOAPY_REMOTE_CF16 "CF16"
+
+/*!
+ * Convert a buffer of complex elements for one channel.
+ * The scale factor is the stream's remote scale factor,
+ * each kernel derives its own scaling constants from it.
+ */
+typedef void (*ConvertFunction)(const void *in, void *out, const size_t numElems, const double scaleFactor);
+
+//! The conversion kernels between a local and a remote stream format
+struct ConvertKernel
+{
+    std::string localFormat;
+    std::string remoteFormat;
+    ConvertFunction recv; //!< remote format to local format
+    ConvertFunction send; //!< local format to remote format
+    const char *isa; //!< name of the fastest instruction set used
+};
+
+/*!
+ * Find the conversion kernels for a pair of stream formats.
+ * The kernels are selected once at runtime from the CPU features.
+ * All kernels produce bit-exact results with the generic kernels,
+ * and float to integer conversions saturate on overflow.
+ * When both formats are the same the kernels are null,
+ * and the caller copies the buffers instead.
+ * \return the kernels or nullptr when the conversion is not supported
+ */
+const ConvertKernel *findConvertKernel(const std::string &localFormat, const std::string &remoteFormat);
+
+/*!
+ * Get the local formats that a stream can use on top of the remote formats:
+ * the remote formats in order, followed by every format they convert into.
+ */
+std::vector<std::string> getConvertLocalFormats(const std::vector<std::string> &remoteFormats);
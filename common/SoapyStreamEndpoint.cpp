@@ -3,7 +3,10 @@
 
 #include <SoapySDR/Errors.hpp>
 #include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Formats.hpp>
 #include "SoapyStreamEndpoint.hpp"
+#include "SoapyStreamCodec.hpp"
+#include "SoapyStreamConvert.hpp"
 #include "SoapyRPCSocket.hpp"
 #include "SoapyURLUtils.hpp"
 #include "SoapyRemoteDefs.hpp"
@@ -11,12 +14,45 @@
 #include <algorithm> //min/max
 #include <cassert>
 #include <cstdint>
+#include <cstring> //memcpy
+#include <chrono>
+#include <stdexcept>
 
 #define HEADER_SIZE sizeof(StreamDatagramHeader)
 
 //use the larger IPv6 header size
 #define PROTO_HEADER_SIZE (40 + 8) //IPv6 + UDP
 
+//the adaptive wire format measures congestion over this interval
+#define ADAPT_INTERVAL_US (100*1000) //100 ms
+
+//an interval is congested when stalled for this share of it
+#define ADAPT_STALL_PERCENT 10
+
+//step back up after this many intervals without congestion
+#define ADAPT_QUIET_INTERVALS 30 //3 s
+
+/*!
+ * The adaptive wire format ladder for CS16 streams.
+ * The narrow formats keep the top bits of each component,
+ * and use the CS16 conversion kernels in both directions.
+ * The CS12 kernels shift without a scale factor,
+ * these scale factors make the CS8 kernels shift by 8 bits.
+ */
+struct AdaptiveFormat
+{
+    const char *format;
+    uint8_t tag; //first payload byte of a narrow datagram
+    double narrowScale;
+    double widenScale;
+};
+
+static const AdaptiveFormat adaptiveFormats[] = {
+    {SOAPY_SDR_CS16, 16, 0.0, 0.0},
+    {SOAPY_SDR_CS12, 12, 0.0, 0.0},
+    {SOAPY_SDR_CS8, 8, 32768.0, 128.0},
+};
+
 struct StreamDatagramHeader
 {
     uint32_t bytes; //!< total number of bytes in datagram
@@ -50,23 +86,21 @@ SoapyStreamEndpoint::SoapyStreamEndpoint(
     _lastRecvSequence(0),
     _maxInFlightSeqs(0),
     _receiveInitial(false),
-    _triggerAckWindow(0)
+    _triggerAckWindow(0),
+    _codec(nullptr),
+    _codecStats(),
+    _adaptive(false),
+    _adaptLevel(0),
+    _adaptQuietIntervals(0),
+    _adaptLoss(false),
+    _adaptStalled(false),
+    _adaptStallNs(0),
+    _recvDrops(0),
+    _peerDrops(0)
 {
     assert(not _streamSock.null());
 
-    //allocate buffer data and default state
-    _buffData.resize(_numBuffs);
-    for (auto &data : _buffData)
-    {
-        data.acquired = false;
-        data.buff.resize(_xferSize);
-        data.buffs.resize(_numChans);
-        for (size_t i = 0; i < _numChans; i++)
-        {
-            size_t offsetBytes = HEADER_SIZE+(i*_buffSize*_elemSize);
-            data.buffs[i] = (void*)(data.buff.data()+offsetBytes);
-        }
-    }
+    this->allocateBuffers();
 
     //endpoints require a large socket buffer in the data direction
     int ret = _streamSock.setBuffSize(isRecv, window);
@@ -111,7 +145,240 @@ SoapyStreamEndpoint::SoapyStreamEndpoint(
 
 SoapyStreamEndpoint::~SoapyStreamEndpoint(void)
 {
-    return;
+    if (_codec == nullptr) return;
+
+    //print the codec summary for this stream
+    const auto &stats = _codecStats;
+    SoapySDR::logf(SOAPY_SDR_INFO, "StreamEndpoint codec: %d encoded and %d raw datagrams, ratio %.2f, %.2f ns/byte",
+        int(stats.codedDatagrams), int(stats.rawDatagrams),
+        (stats.wireBytes == 0)?1.0:(double(stats.rawBytes)/stats.wireBytes),
+        (stats.rawBytes == 0)?0.0:(double(stats.codecNs)/stats.rawBytes));
+    delete _codec;
+}
+
+void SoapyStreamEndpoint::enableCodec(const std::string &codec, const std::string &format)
+{
+    if (_adaptive) throw std::runtime_error(
+        "SoapyRemote::SoapyStreamEndpoint::enableCodec() not supported with the adaptive wire format");
+    delete _codec;
+    _codec = new SoapyStreamCodec(codec, format);
+    _codecBuff.resize(_xferSize);
+
+    //grow the buffers to the most elements that encode into a datagram
+    if (not _codec->isLossless())
+    {
+        const size_t payloadBytes = _xferSize-HEADER_SIZE;
+        while (_numChans*_codec->fixedBytes(_buffSize+1) <= payloadBytes) _buffSize++;
+        this->allocateBuffers();
+    }
+
+    SoapySDR::logf(SOAPY_SDR_INFO, "StreamEndpoint %s codec enabled for %s: %d elements",
+        codec.c_str(), format.c_str(), int(_buffSize*_numChans));
+}
+
+void SoapyStreamEndpoint::enableAdaptive(const std::string &format)
+{
+    if (format != SOAPY_SDR_CS16) throw std::runtime_error(
+        "SoapyRemote::SoapyStreamEndpoint::enableAdaptive() format not supported: "+format);
+    if (_codec != nullptr) throw std::runtime_error(
+        "SoapyRemote::SoapyStreamEndpoint::enableAdaptive() not supported with a payload codec");
+
+    _adaptKernels.clear();
+    for (const auto &adapt : adaptiveFormats)
+    {
+        _adaptKernels.push_back(findConvertKernel(format, adapt.format));
+    }
+    _codecBuff.resize(_xferSize);
+    _adaptive = true;
+    _adaptLevel = 0;
+    _adaptDeadline = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(ADAPT_INTERVAL_US);
+
+    SoapySDR::logf(SOAPY_SDR_INFO, "StreamEndpoint adaptive wire format enabled for %s", format.c_str());
+}
+
+void SoapyStreamEndpoint::updateAdaptive(void)
+{
+    const auto now = std::chrono::high_resolution_clock::now();
+    if (now < _adaptDeadline) return;
+
+    //step down on loss or a sustained stall, step up after a quiet period
+    const long long intervalNs = (long long)(ADAPT_INTERVAL_US)*1000;
+    const bool congested = _adaptLoss or _adaptStallNs*100 >= intervalNs*ADAPT_STALL_PERCENT;
+    const size_t lastLevel = _adaptLevel;
+    if (congested)
+    {
+        if (_adaptLevel+1 < _adaptKernels.size()) _adaptLevel++;
+        _adaptQuietIntervals = 0;
+    }
+    else if (++_adaptQuietIntervals >= ADAPT_QUIET_INTERVALS)
+    {
+        if (_adaptLevel != 0) _adaptLevel--;
+        _adaptQuietIntervals = 0;
+    }
+    if (_adaptLevel != lastLevel)
+    {
+        SoapySDR::logf(SOAPY_SDR_INFO, "StreamEndpoint adaptive wire format %s -> %s (%s)",
+            adaptiveFormats[lastLevel].format, adaptiveFormats[_adaptLevel].format,
+            _adaptLoss?"loss":(congested?"stalls":"recovered"));
+    }
+
+    _adaptLoss = false;
+    _adaptStallNs = 0;
+    _adaptDeadline = now + std::chrono::microseconds(ADAPT_INTERVAL_US);
+}
+
+size_t SoapyStreamEndpoint::narrowPayload(const void * const *buffs, const size_t numElems, const size_t rawBytes)
+{
+    this->updateAdaptive();
+    if (_adaptLevel == 0) return 0;
+
+    //the tag and the channels back to back must be smaller than the raw payload
+    const auto &adapt = adaptiveFormats[_adaptLevel];
+    const size_t chanBytes = numElems*SoapySDR::formatToSize(adapt.format);
+    const size_t narrowBytes = 1+(_numChans*chanBytes);
+    if (narrowBytes >= rawBytes) return 0;
+
+    char *payload = _codecBuff.data()+HEADER_SIZE;
+    payload[0] = char(adapt.tag);
+    for (size_t i = 0; i < _numChans; i++)
+    {
+        _adaptKernels[_adaptLevel]->send(buffs[i], payload+1+(i*chanBytes), numElems, adapt.narrowScale);
+    }
+    return narrowBytes;
+}
+
+int SoapyStreamEndpoint::widenPayload(const char *payload, const size_t numBytes, void * const *buffs, const int numElemsOrErr)
+{
+    if (numElemsOrErr <= 0) return numElemsOrErr;
+    const size_t numElems = size_t(numElemsOrErr);
+    if (numElems > _buffSize)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::widenPayload(%d elements), FAILED bad header", numElemsOrErr);
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+
+    //raw payloads keep each channel at the usual datagram offset
+    const size_t rawBytes = (((_numChans-1)*_buffSize)+numElems)*_elemSize;
+    if (numBytes >= rawBytes)
+    {
+        for (size_t i = 0; i < _numChans; i++)
+        {
+            std::memcpy(buffs[i], payload+(i*_buffSize*_elemSize), numElems*_elemSize);
+        }
+        return numElemsOrErr;
+    }
+
+    //narrow payloads carry the tag and the channels back to back
+    size_t level = 1;
+    while (level < _adaptKernels.size() and adaptiveFormats[level].tag != uint8_t(payload[0])) level++;
+    const size_t chanBytes = (level < _adaptKernels.size())?(numElems*SoapySDR::formatToSize(adaptiveFormats[level].format)):0;
+    if (chanBytes == 0 or numBytes != 1+(_numChans*chanBytes))
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::widenPayload(%d bytes), FAILED bad format", int(numBytes));
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+    for (size_t i = 0; i < _numChans; i++)
+    {
+        _adaptKernels[level]->recv(payload+1+(i*chanBytes), buffs[i], numElems, adaptiveFormats[level].widenScale);
+    }
+    return numElemsOrErr;
+}
+
+size_t SoapyStreamEndpoint::encodePayload(const void * const *buffs, const size_t numElems, const size_t rawBytes)
+{
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    //the channels are encoded back to back after the header,
+    //and lossless encoding is only used when smaller than the raw payload
+    char *payload = _codecBuff.data()+HEADER_SIZE;
+    const size_t maxBytes = _codec->isLossless()?(rawBytes-1):(_codecBuff.size()-HEADER_SIZE);
+    size_t codedBytes = 0;
+    for (size_t i = 0; i < _numChans; i++)
+    {
+        const size_t numBytes = _codec->encode(buffs[i], numElems, payload+codedBytes, maxBytes-codedBytes);
+        if (numBytes == 0) {codedBytes = 0; break;}
+        codedBytes += numBytes;
+    }
+
+    const auto stopTime = std::chrono::high_resolution_clock::now();
+    _codecStats.codecNs += std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime-startTime).count();
+    _codecStats.rawBytes += _numChans*numElems*_elemSize;
+    _codecStats.wireBytes += (codedBytes == 0)?rawBytes:codedBytes;
+    if (codedBytes == 0) _codecStats.rawDatagrams++;
+    else _codecStats.codedDatagrams++;
+    return codedBytes;
+}
+
+int SoapyStreamEndpoint::decodePayload(const char *payload, const size_t numBytes, void * const *buffs, const int numElemsOrErr)
+{
+    if (numElemsOrErr <= 0) return numElemsOrErr;
+    const size_t numElems = size_t(numElemsOrErr);
+    if (numElems > _buffSize)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::decodePayload(%d elements), FAILED bad header", numElemsOrErr);
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    const size_t rawBytes = (((_numChans-1)*_buffSize)+numElems)*_elemSize;
+    _codecStats.rawBytes += _numChans*numElems*_elemSize;
+    _codecStats.wireBytes += numBytes;
+
+    //lossy payloads are always encoded at a fixed size
+    if (not _codec->isLossless() and numBytes != _numChans*_codec->fixedBytes(numElems))
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::decodePayload(%d bytes), FAILED bad size", int(numBytes));
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+
+    //raw payloads keep each channel at the usual datagram offset
+    else if (_codec->isLossless() and numBytes >= rawBytes)
+    {
+        for (size_t i = 0; i < _numChans; i++)
+        {
+            std::memcpy(buffs[i], payload+(i*_buffSize*_elemSize), numElems*_elemSize);
+        }
+        _codecStats.rawDatagrams++;
+        return numElemsOrErr;
+    }
+
+    //encoded payloads carry the channels back to back
+    size_t offset = 0;
+    for (size_t i = 0; i < _numChans; i++)
+    {
+        const size_t chanBytes = _codec->decode(payload+offset, numBytes-offset, buffs[i], numElems);
+        if (chanBytes == 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::decodePayload(%d bytes), FAILED malformed channel %d", int(numBytes), int(i));
+            return SOAPY_SDR_STREAM_ERROR;
+        }
+        offset += chanBytes;
+    }
+
+    const auto stopTime = std::chrono::high_resolution_clock::now();
+    _codecStats.codecNs += std::chrono::duration_cast<std::chrono::nanoseconds>(stopTime-startTime).count();
+    _codecStats.codedDatagrams++;
+    return numElemsOrErr;
+}
+
+void SoapyStreamEndpoint::allocateBuffers(void)
+{
+    //allocate buffer data and default state
+    _buffData.resize(_numBuffs);
+    for (auto &data : _buffData)
+    {
+        data.acquired = false;
+        data.buff.resize(std::max(_xferSize, HEADER_SIZE+(_numChans*_buffSize*_elemSize)));
+        data.buffs.resize(_numChans);
+        for (size_t i = 0; i < _numChans; i++)
+        {
+            size_t offsetBytes = HEADER_SIZE+(i*_buffSize*_elemSize);
+            data.buffs[i] = (void*)(data.buff.data()+offsetBytes);
+        }
+    }
+
+    //padding fills out the leading channels of short direct datagrams
+    if (_numChans > 1) _padBuff.resize(_buffSize*_elemSize);
 }
 
 void SoapyStreamEndpoint::sendACK(void)
@@ -120,7 +387,7 @@ void SoapyStreamEndpoint::sendACK(void)
     header.bytes = htonl(sizeof(header));
     header.sequence = htonl(_lastRecvSequence);
     header.elems = htonl(_maxInFlightSeqs);
-    header.flags = htonl(0);
+    header.flags = htonl(_recvDrops);
     header.time = htonll(0);
 
     //send the flow control ACK
@@ -157,6 +424,11 @@ void SoapyStreamEndpoint::recvACK(void)
 
     _lastRecvSequence = ntohl(header.sequence);
     _maxInFlightSeqs = ntohl(header.elems);
+
+    //the receiver reports its count of lost datagrams
+    const uint32_t drops = ntohl(header.flags);
+    if (drops != _peerDrops) _adaptLoss = true;
+    _peerDrops = drops;
 }
 
 /***********************************************************************
@@ -169,10 +441,56 @@ bool SoapyStreamEndpoint::waitRecv(const long timeoutUs)
     return _streamSock.selectRecv(timeoutUs);
 }
 
-int SoapyStreamEndpoint::acquireRecv(size_t &handle, const void **buffs, int &flags, long long &timeNs)
+int SoapyStreamEndpoint::recvDatagram(char *buff, const char *what)
 {
     int ret = 0;
 
+    //receive the header or the entire datagram
+    assert(not _streamSock.null());
+    if (_datagramMode) ret = _streamSock.recv(buff, _xferSize);
+    else ret = _streamSock.recv(buff, HEADER_SIZE, MSG_WAITALL);
+    if (ret < 0)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::%s(), FAILED %s", what, _streamSock.lastErrorMsg());
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+    size_t bytesRecvd = size_t(ret);
+    _receiveInitial = true;
+
+    //check the header
+    auto header = (const StreamDatagramHeader*)buff;
+    size_t bytes = ntohl(header->bytes);
+
+    if (_datagramMode and bytes > bytesRecvd)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::%s(%d bytes), FAILED %d\n"
+            "This MTU setting may be unachievable. Check network configuration.", what, int(bytes), ret);
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+
+    if (bytes < HEADER_SIZE or bytes > _xferSize)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::%s(%d bytes), FAILED bad header", what, int(bytes));
+        return SOAPY_SDR_STREAM_ERROR;
+    }
+
+    //receive the rest of the datagram in stream mode
+    while (bytesRecvd < bytes)
+    {
+        ret = _streamSock.recv(buff+bytesRecvd, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, bytes-bytesRecvd));
+        if (ret < 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::%s(), FAILED %s", what, _streamSock.lastErrorMsg());
+            return SOAPY_SDR_STREAM_ERROR;
+        }
+        bytesRecvd += size_t(ret);
+    }
+
+    return int(bytes);
+}
+
+int SoapyStreamEndpoint::acquireRecv(size_t &handle, const void **buffs, int &flags, long long &timeNs)
+{
     //no available handles, the user is hoarding them...
     if (_numHandlesAcquired == _buffData.size())
     {
@@ -184,51 +502,121 @@ int SoapyStreamEndpoint::acquireRecv(size_t &handle, const void **buffs, int &fl
     handle = _nextHandleAcquire;
     auto &data = _buffData[handle];
 
-    //receive into the buffer
+    //receive into the buffer, or into the codec buffer to decode from
+    char *buff = (_codec == nullptr and not _adaptive)?data.buff.data():_codecBuff.data();
+    const int ret = this->recvDatagram(buff, "acquireRecv");
+    if (ret < 0) return ret;
+
+    auto header = (const StreamDatagramHeader*)buff;
+    int numElemsOrErr = this->unloadHeader(*header, flags, timeNs);
+    if (_codec != nullptr) numElemsOrErr = this->decodePayload(buff+HEADER_SIZE, size_t(ret)-HEADER_SIZE, data.buffs.data(), numElemsOrErr);
+    if (_adaptive) numElemsOrErr = this->widenPayload(buff+HEADER_SIZE, size_t(ret)-HEADER_SIZE, data.buffs.data(), numElemsOrErr);
+
+    //increment for next handle
+    if (numElemsOrErr >= 0)
+    {
+        data.acquired = true;
+        _nextHandleAcquire = (_nextHandleAcquire + 1)%_numBuffs;
+        _numHandlesAcquired++;
+    }
+
+    //set output parameters
+    this->getAddrs(handle, (void **)buffs);
+    return numElemsOrErr;
+}
+
+int SoapyStreamEndpoint::recvBuffs(void * const *buffs, int &flags, long long &timeNs)
+{
+    //receive the datagram whole to decode or widen into the caller's buffers
+    if (_codec != nullptr or _adaptive)
+    {
+        const int ret = this->recvDatagram(_codecBuff.data(), "recvBuffs");
+        if (ret < 0) return ret;
+        const int numElemsOrErr = this->unloadHeader(*(const StreamDatagramHeader*)_codecBuff.data(), flags, timeNs);
+        const char *payload = _codecBuff.data()+HEADER_SIZE;
+        if (_adaptive) return this->widenPayload(payload, size_t(ret)-HEADER_SIZE, buffs, numElemsOrErr);
+        return this->decodePayload(payload, size_t(ret)-HEADER_SIZE, buffs, numElemsOrErr);
+    }
+
+    StreamDatagramHeader header;
+    const size_t chanBytes = _buffSize*_elemSize;
+    int ret = 0;
+
+    //receive the header into scratch and each channel at its datagram offset
     assert(not _streamSock.null());
-    if (_datagramMode) ret = _streamSock.recv(data.buff.data(), data.buff.size());
-    else ret = _streamSock.recv(data.buff.data(), HEADER_SIZE, MSG_WAITALL);
+    if (_datagramMode)
+    {
+        _recvPtrs.assign(1, &header);
+        _ioLens.assign(1, HEADER_SIZE);
+        for (size_t i = 0; i < _numChans; i++)
+        {
+            _recvPtrs.push_back(buffs[i]);
+            _ioLens.push_back(chanBytes);
+        }
+        ret = _streamSock.recvv(_recvPtrs.data(), _ioLens.data(), _recvPtrs.size());
+    }
+    else ret = _streamSock.recv(&header, HEADER_SIZE, MSG_WAITALL);
     if (ret < 0)
     {
-        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::acquireRecv(), FAILED %s", _streamSock.lastErrorMsg());
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::recvBuffs(), FAILED %s", _streamSock.lastErrorMsg());
         return SOAPY_SDR_STREAM_ERROR;
     }
-    size_t bytesRecvd = size_t(ret);
     _receiveInitial = true;
 
     //check the header
-    auto header = (const StreamDatagramHeader*)data.buff.data();
-    size_t bytes = ntohl(header->bytes);
+    size_t bytes = ntohl(header.bytes);
 
-    if (_datagramMode and bytes > bytesRecvd)
+    if (_datagramMode and bytes > size_t(ret))
     {
-        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::acquireRecv(%d bytes), FAILED %d\n"
+        SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::recvBuffs(%d bytes), FAILED %d\n"
             "This MTU setting may be unachievable. Check network configuration.", int(bytes), ret);
         return SOAPY_SDR_STREAM_ERROR;
     }
 
-    else while (bytesRecvd < bytes)
+    else if (not _datagramMode)
     {
-        ret = _streamSock.recv(data.buff.data()+bytesRecvd, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, bytes-bytesRecvd));
-        if (ret < 0)
+        if (bytes < HEADER_SIZE or bytes > HEADER_SIZE+(_numChans*chanBytes))
         {
-            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::acquireRecv(), FAILED %s", _streamSock.lastErrorMsg());
+            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::recvBuffs(%d bytes), FAILED bad header", int(bytes));
             return SOAPY_SDR_STREAM_ERROR;
         }
-        bytesRecvd += size_t(ret);
+        size_t bytesLeft = bytes-HEADER_SIZE;
+        for (size_t i = 0; bytesLeft != 0; i++)
+        {
+            char *buff = (char *)buffs[i];
+            const size_t numBytes = std::min(bytesLeft, chanBytes);
+            size_t bytesRecvd = 0;
+            while (bytesRecvd < numBytes)
+            {
+                ret = _streamSock.recv(buff+bytesRecvd, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, numBytes-bytesRecvd));
+                if (ret < 0)
+                {
+                    SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::recvBuffs(), FAILED %s", _streamSock.lastErrorMsg());
+                    return SOAPY_SDR_STREAM_ERROR;
+                }
+                bytesRecvd += size_t(ret);
+            }
+            bytesLeft -= numBytes;
+        }
     }
 
-    const int numElemsOrErr = int(ntohl(header->elems));
+    return this->unloadHeader(header, flags, timeNs);
+}
+
+int SoapyStreamEndpoint::unloadHeader(const StreamDatagramHeader &header, int &flags, long long &timeNs)
+{
+    const int numElemsOrErr = int(ntohl(header.elems));
 
     //dropped or out of order packets
     //TODO return an error code, more than a notification
-    if (uint32_t(_lastRecvSequence) != uint32_t(ntohl(header->sequence)))
+    if (uint32_t(_lastRecvSequence) != uint32_t(ntohl(header.sequence)))
     {
         SoapySDR::log(SOAPY_SDR_SSI, "S");
+        _recvDrops++;
     }
 
     //update flow control
-    _lastRecvSequence = ntohl(header->sequence)+1;
+    _lastRecvSequence = ntohl(header.sequence)+1;
 
     //has there been at least trigger window number of sequences since the last ACK?
     if (uint32_t(_lastRecvSequence-_lastSendSequence) >= _triggerAckWindow)
@@ -236,18 +624,8 @@ int SoapyStreamEndpoint::acquireRecv(size_t &handle, const void **buffs, int &fl
         this->sendACK();
     }
 
-    //increment for next handle
-    if (numElemsOrErr >= 0)
-    {
-        data.acquired = true;
-        _nextHandleAcquire = (_nextHandleAcquire + 1)%_numBuffs;
-        _numHandlesAcquired++;
-    }
-
-    //set output parameters
-    this->getAddrs(handle, (void **)buffs);
-    flags = ntohl(header->flags);
-    timeNs = ntohll(header->time);
+    flags = ntohl(header.flags);
+    timeNs = ntohll(header.time);
     return numElemsOrErr;
 }
 
@@ -273,6 +651,13 @@ bool SoapyStreamEndpoint::waitSend(const long timeoutUs)
     //are we within the allowed number of sequences in flight?
     while (not _receiveInitial or uint32_t(_lastSendSequence-_lastRecvSequence) >= _maxInFlightSeqs)
     {
+        //time the stalls on a full window for the adaptive wire format
+        if (_adaptive and _receiveInitial and not _adaptStalled)
+        {
+            _adaptStalled = true;
+            _adaptStallStart = std::chrono::high_resolution_clock::now();
+        }
+
         //wait for a flow control ACK to arrive
         if (not _streamSock.selectRecv(timeoutUs)) return false;
 
@@ -280,6 +665,12 @@ bool SoapyStreamEndpoint::waitSend(const long timeoutUs)
         while (_streamSock.selectRecv(0)) this->recvACK();
     }
 
+    if (_adaptStalled)
+    {
+        const auto stallTime = std::chrono::high_resolution_clock::now() - _adaptStallStart;
+        _adaptStallNs += std::chrono::duration_cast<std::chrono::nanoseconds>(stallTime).count();
+        _adaptStalled = false;
+    }
     return true;
 }
 
@@ -317,20 +708,31 @@ void SoapyStreamEndpoint::releaseSend(const size_t handle, const int numElemsOrE
     const size_t totalElems = ((_numChans-1)*_buffSize) + numElemsOrErr;
 
     //load the header
-    auto header = (StreamDatagramHeader*)data.buff.data();
+    char *buff = data.buff.data();
     size_t bytes = HEADER_SIZE + ((numElemsOrErr < 0)?0:(totalElems*_elemSize));
-    header->bytes = htonl(bytes);
-    header->sequence = htonl(_lastSendSequence++);
-    header->elems = htonl(numElemsOrErr);
-    header->flags = htonl(flags);
-    header->time = htonll(timeNs);
+
+    //send the encoded or narrow payload from the codec buffer when smaller
+    if ((_codec != nullptr or _adaptive) and numElemsOrErr > 0)
+    {
+        const size_t codedBytes = _adaptive?
+            this->narrowPayload(data.buffs.data(), size_t(numElemsOrErr), bytes-HEADER_SIZE):
+            this->encodePayload(data.buffs.data(), size_t(numElemsOrErr), bytes-HEADER_SIZE);
+        if (codedBytes != 0)
+        {
+            buff = _codecBuff.data();
+            bytes = HEADER_SIZE+codedBytes;
+        }
+    }
+
+    auto header = (StreamDatagramHeader*)buff;
+    this->loadHeader(*header, bytes, numElemsOrErr, flags, timeNs);
 
     //send from the buffer
     assert(not _streamSock.null());
     size_t bytesSent = 0;
     while (bytesSent < bytes)
     {
-        int ret = _streamSock.send(data.buff.data()+bytesSent, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, bytes-bytesSent));
+        int ret = _streamSock.send(buff+bytesSent, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, bytes-bytesSent));
         if (ret < 0)
         {
             SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::releaseSend(), FAILED %s", _streamSock.lastErrorMsg());
@@ -353,6 +755,89 @@ void SoapyStreamEndpoint::releaseSend(const size_t handle, const int numElemsOrE
     }
 }
 
+void SoapyStreamEndpoint::sendBuffs(const void * const *buffs, const int numElemsOrErr, const int flags, const long long timeNs)
+{
+    //The first N-1 channels are padded out to complete buffSize elements,
+    //so that the receiver finds each channel at the usual datagram offset.
+    const size_t numElems = (numElemsOrErr < 0)?0:size_t(numElemsOrErr);
+    assert(numElems <= _buffSize);
+    const size_t padBytes = (_buffSize-numElems)*_elemSize;
+
+    StreamDatagramHeader header;
+    size_t bytes = HEADER_SIZE;
+    _sendPtrs.assign(1, &header);
+    _ioLens.assign(1, HEADER_SIZE);
+    for (size_t i = 0; numElems != 0 and i < _numChans; i++)
+    {
+        _sendPtrs.push_back(buffs[i]);
+        _ioLens.push_back(numElems*_elemSize);
+        bytes += numElems*_elemSize;
+        if (i+1 == _numChans or padBytes == 0) continue;
+        _sendPtrs.push_back(_padBuff.data());
+        _ioLens.push_back(padBytes);
+        bytes += padBytes;
+    }
+
+    //replace the payload with the encoded or narrow channels when smaller
+    if ((_codec != nullptr or _adaptive) and numElems != 0)
+    {
+        const size_t codedBytes = _adaptive?
+            this->narrowPayload(buffs, numElems, bytes-HEADER_SIZE):
+            this->encodePayload(buffs, numElems, bytes-HEADER_SIZE);
+        if (codedBytes != 0)
+        {
+            bytes = HEADER_SIZE+codedBytes;
+            _sendPtrs.assign(1, &header);
+            _ioLens.assign(1, HEADER_SIZE);
+            _sendPtrs.push_back(_codecBuff.data()+HEADER_SIZE);
+            _ioLens.push_back(codedBytes);
+        }
+    }
+    this->loadHeader(header, bytes, numElemsOrErr, flags, timeNs);
+
+    //send the entire datagram with a single gather call
+    assert(not _streamSock.null());
+    if (_datagramMode)
+    {
+        int ret = _streamSock.sendv(_sendPtrs.data(), _ioLens.data(), _sendPtrs.size());
+        if (ret < 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::sendBuffs(), FAILED %s", _streamSock.lastErrorMsg());
+        }
+        else if (size_t(ret) != bytes)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::sendBuffs(%d bytes), FAILED %d", int(bytes), ret);
+        }
+        return;
+    }
+
+    //or send each piece in chunks for the stream socket
+    for (size_t i = 0; i < _sendPtrs.size(); i++)
+    {
+        const char *buff = (const char *)_sendPtrs[i];
+        size_t bytesSent = 0;
+        while (bytesSent < _ioLens[i])
+        {
+            int ret = _streamSock.send(buff+bytesSent, std::min<size_t>(SOAPY_REMOTE_SOCKET_BUFFMAX, _ioLens[i]-bytesSent));
+            if (ret < 0)
+            {
+                SoapySDR::logf(SOAPY_SDR_ERROR, "StreamEndpoint::sendBuffs(), FAILED %s", _streamSock.lastErrorMsg());
+                return;
+            }
+            bytesSent += size_t(ret);
+        }
+    }
+}
+
+void SoapyStreamEndpoint::loadHeader(StreamDatagramHeader &header, const size_t bytes, const int numElemsOrErr, const int flags, const long long timeNs)
+{
+    header.bytes = htonl(bytes);
+    header.sequence = htonl(_lastSendSequence++);
+    header.elems = htonl(numElemsOrErr);
+    header.flags = htonl(flags);
+    header.time = htonll(timeNs);
+}
+
 /***********************************************************************
  * status endpoint implementation -- used by both directions
  **********************************************************************/
@@ -4,9 +4,15 @@
 #pragma once
 #include "SoapyRemoteConfig.hpp"
 #include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
+#include <chrono>
 
 class SoapyRPCSocket;
+class SoapyStreamCodec;
+struct StreamDatagramHeader;
+struct ConvertKernel;
 
 /*!
  * The stream endpoint supports a windowed link datagram protocol.
@@ -52,6 +58,27 @@ public:
         return _numBuffs;
     }
 
+    /*!
+     * Enable a payload codec for this stream format.
+     * Both endpoints of the stream must enable the same codec.
+     * With the lossless codec, each datagram is sent encoded
+     * only when it is smaller, the receiver tells them apart
+     * from the datagram size. With a lossy codec, every datagram
+     * is encoded, and the buffer size grows to fill the datagram.
+     */
+    void enableCodec(const std::string &codec, const std::string &format);
+
+    /*!
+     * Adapt the wire format of a CS16 stream to the network.
+     * Both endpoints of the stream must enable it.
+     * The sender narrows datagrams to CS12 and then CS8
+     * after sustained flow control stalls or reported loss,
+     * and steps back up after a period without congestion.
+     * Each narrow datagram starts with a tag of its format,
+     * and the receiver restores CS16 at the same scale.
+     */
+    void enableAdaptive(const std::string &format);
+
     //! Query handle addresses
     void getAddrs(const size_t handle, void **buffs) const
     {
@@ -82,6 +109,15 @@ public:
      */
     void releaseRecv(const size_t handle);
 
+    /*!
+     * Receive a datagram directly into the caller's buffers.
+     * This replaces acquireRecv and releaseRecv without a copy.
+     * Each buffer must hold getBuffSize() elements,
+     * the contents past the number of elements are undefined.
+     * return the number of elements or error code
+     */
+    int recvBuffs(void * const *buffs, int &flags, long long &timeNs);
+
     /*******************************************************************
      * send endpoint API
      ******************************************************************/
@@ -103,6 +139,13 @@ public:
      */
     void releaseSend(const size_t handle, const int numElemsOrErr, int &flags, const long long timeNs);
 
+    /*!
+     * Send a datagram directly from the caller's buffers.
+     * This replaces acquireSend and releaseSend without a copy.
+     * Pass in up to getBuffSize() elements or error code.
+     */
+    void sendBuffs(const void * const *buffs, const int numElemsOrErr, const int flags, const long long timeNs);
+
     /*******************************************************************
      * status endpoint API -- used by both directions
      ******************************************************************/
@@ -130,7 +173,7 @@ private:
     const size_t _xferSize;
     const size_t _numChans;
     const size_t _elemSize;
-    const size_t _buffSize;
+    size_t _buffSize; //grows with a lossy codec
     const size_t _numBuffs;
 
     struct BufferData
@@ -140,6 +183,7 @@ private:
         bool acquired;
     };
     std::vector<BufferData> _buffData;
+    void allocateBuffers(void);
 
     //acquire+release tracking
     size_t _nextHandleAcquire;
@@ -158,4 +202,58 @@ private:
     //flow control helpers
     void sendACK(void);
     void recvACK(void);
+
+    //datagram header helpers
+    int unloadHeader(const StreamDatagramHeader &header, int &flags, long long &timeNs);
+    void loadHeader(StreamDatagramHeader &header, const size_t bytes, const int numElemsOrErr, const int flags, const long long timeNs);
+
+    //optional lossless payload codec
+    SoapyStreamCodec *_codec;
+    std::vector<char> _codecBuff; //header and encoded or narrow payload
+    struct CodecStats
+    {
+        size_t rawDatagrams; //sent or received without encoding
+        size_t codedDatagrams;
+        unsigned long long rawBytes; //sample bytes before encoding
+        unsigned long long wireBytes; //payload bytes on the network
+        long long codecNs; //time spent encoding or decoding
+    };
+    CodecStats _codecStats;
+
+    //optional adaptive wire format, index 0 is the stream format
+    bool _adaptive;
+    std::vector<const ConvertKernel *> _adaptKernels;
+    size_t _adaptLevel;
+    size_t _adaptQuietIntervals; //intervals without congestion at this level
+    bool _adaptLoss; //the receiver reported loss this interval
+    bool _adaptStalled; //waiting on a full flow control window
+    long long _adaptStallNs; //time spent stalled this interval
+    std::chrono::high_resolution_clock::time_point _adaptStallStart;
+    std::chrono::high_resolution_clock::time_point _adaptDeadline;
+    void updateAdaptive(void);
+
+    //narrow into the codec buffer, return the payload bytes or 0 to send raw
+    size_t narrowPayload(const void * const *buffs, const size_t numElems, const size_t rawBytes);
+
+    //widen or copy the payload into the buffers, return the elements or error code
+    int widenPayload(const char *payload, const size_t numBytes, void * const *buffs, const int numElemsOrErr);
+
+    //lost datagrams counted by the receiver and reported in the ACK
+    uint32_t _recvDrops;
+    uint32_t _peerDrops;
+
+    //encode into the codec buffer, return the payload bytes or 0 to send raw
+    size_t encodePayload(const void * const *buffs, const size_t numElems, const size_t rawBytes);
+
+    //decode or copy the payload into the buffers, return the elements or error code
+    int decodePayload(const char *payload, const size_t numBytes, void * const *buffs, const int numElemsOrErr);
+
+    //receive an entire datagram into the buffer, return the bytes or error code
+    int recvDatagram(char *buff, const char *what);
+
+    //scatter/gather lists for the direct buffer API
+    std::vector<const void *> _sendPtrs;
+    std::vector<void *> _recvPtrs;
+    std::vector<size_t> _ioLens;
+    std::vector<char> _padBuff; //padding for short multi-channel datagrams
 };
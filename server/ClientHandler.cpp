@@ -5,6 +5,10 @@
 #include "ClientHandler.hpp"
 #include "ServerStreamData.hpp"
 #include "LogForwarding.hpp"
+#include "SensorPublisher.hpp"
+#include "CommandExecutor.hpp"
+#include "SweepEngine.hpp"
+#include "ScriptRunner.hpp"
 #include "SoapyInfoUtils.hpp"
 #include "SoapyRemoteDefs.hpp"
 #include "SoapyURLUtils.hpp"
@@ -12,6 +16,8 @@
 #include "SoapyRPCPacker.hpp"
 #include "SoapyRPCUnpacker.hpp"
 #include "SoapyStreamEndpoint.hpp"
+#include "SoapyStreamConvert.hpp"
+#include "SoapyStreamCodec.hpp"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Logger.hpp>
 #include <SoapySDR/Formats.hpp>
@@ -25,11 +31,15 @@ static std::mutex factoryMutex;
 /***********************************************************************
  * Client handler constructor
  **********************************************************************/
-SoapyClientHandler::SoapyClientHandler(SoapyRPCSocket &sock, const std::string &uuid):
+SoapyClientHandler::SoapyClientHandler(SoapyRPCSocket &sock, const std::string &uuid, ServerStreamReactor *reactor):
     _sock(sock),
     _uuid(uuid),
+    _reactor(reactor),
     _dev(nullptr),
     _logForwarder(nullptr),
+    _sensorPublisher(nullptr),
+    _commandExecutor(nullptr),
+    _sweepEngine(nullptr),
     _nextStreamId(0)
 {
     return;
@@ -37,6 +47,11 @@ SoapyClientHandler::SoapyClientHandler(SoapyRPCSocket &sock, const std::string &
 
 SoapyClientHandler::~SoapyClientHandler(void)
 {
+    //stop sampling sensors, executing commands, and sweeping before the device goes away
+    delete _sensorPublisher;
+    delete _commandExecutor;
+    delete _sweepEngine;
+
     //stop all stream threads and close streams
     for (auto &data : _streamData)
     {
@@ -67,6 +82,10 @@ bool SoapyClientHandler::handleOnce(void)
     SoapyRPCUnpacker unpacker(_sock, true, -1/*no timeout*/);
     SoapyRPCPacker packer(_sock, unpacker.remoteRPCVersion());
 
+    //tag the reply to a pipelined call with its request ID,
+    //calls are handled in the order received on this connection
+    if (unpacker.requestId() >= 0) packer.packReplyId(unpacker.requestId());
+
     //handle the client's request
     bool again = true;
     try
@@ -81,6 +100,11 @@ bool SoapyClientHandler::handleOnce(void)
     //send the result back
     packer();
 
+    //pushed sensor updates, command reports, and sweep results follow the reply to the start
+    if (_sensorPublisher != nullptr) _sensorPublisher->start();
+    if (_commandExecutor != nullptr) _commandExecutor->start();
+    if (_sweepEngine != nullptr) _sweepEngine->start();
+
     return again;
 }
 
@@ -91,7 +115,65 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
 {
     SoapyRemoteCalls call;
     unpacker & call;
+    return this->handleCall(call, unpacker, packer);
+}
 
+//the calls that the client batches: the setters held in a batch,
+//and the property getters of the cache prefetch
+static bool isBatchCall(const SoapyRemoteCalls call)
+{
+    switch (call)
+    {
+    case SOAPY_REMOTE_GET_NUM_CHANNELS:
+    case SOAPY_REMOTE_GET_SETTING_INFO:
+    case SOAPY_REMOTE_LIST_ANTENNAS:
+    case SOAPY_REMOTE_GET_GAIN_RANGE:
+    case SOAPY_REMOTE_GET_FREQUENCY_RANGE:
+    case SOAPY_REMOTE_LIST_SAMPLE_RATES:
+    case SOAPY_REMOTE_GET_STREAM_FORMATS:
+    case SOAPY_REMOTE_GET_CHANNEL_SETTING_INFO:
+    case SOAPY_REMOTE_SET_FRONTEND_MAPPING:
+    case SOAPY_REMOTE_SET_ANTENNA:
+    case SOAPY_REMOTE_SET_DC_OFFSET_MODE:
+    case SOAPY_REMOTE_SET_DC_OFFSET:
+    case SOAPY_REMOTE_SET_IQ_BALANCE_MODE:
+    case SOAPY_REMOTE_SET_IQ_BALANCE_MODE_AUTO:
+    case SOAPY_REMOTE_SET_FREQUENCY_CORRECTION:
+    case SOAPY_REMOTE_SET_GAIN_MODE:
+    case SOAPY_REMOTE_SET_GAIN:
+    case SOAPY_REMOTE_SET_GAIN_ELEMENT:
+    case SOAPY_REMOTE_SET_FREQUENCY:
+    case SOAPY_REMOTE_SET_FREQUENCY_COMPONENT:
+    case SOAPY_REMOTE_SET_SAMPLE_RATE:
+    case SOAPY_REMOTE_SET_BANDWIDTH:
+    case SOAPY_REMOTE_SET_MASTER_CLOCK_RATE:
+    case SOAPY_REMOTE_SET_REF_CLOCK_RATE:
+    case SOAPY_REMOTE_SET_CLOCK_SOURCE:
+    case SOAPY_REMOTE_SET_TIME_SOURCE:
+    case SOAPY_REMOTE_SET_HARDWARE_TIME:
+    case SOAPY_REMOTE_SET_COMMAND_TIME:
+    case SOAPY_REMOTE_WRITE_REGISTER:
+    case SOAPY_REMOTE_WRITE_REGISTER_NAMED:
+    case SOAPY_REMOTE_WRITE_REGISTERS:
+    case SOAPY_REMOTE_WRITE_SETTING:
+    case SOAPY_REMOTE_WRITE_CHANNEL_SETTING:
+    case SOAPY_REMOTE_WRITE_GPIO:
+    case SOAPY_REMOTE_WRITE_GPIO_MASKED:
+    case SOAPY_REMOTE_WRITE_GPIO_DIR:
+    case SOAPY_REMOTE_WRITE_GPIO_DIR_MASKED:
+    case SOAPY_REMOTE_WRITE_I2C:
+    case SOAPY_REMOTE_WRITE_UART:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//a packed call is at least its type byte and one packed integer
+static const size_t BATCH_MIN_CALL_BYTES = 2+sizeof(int);
+
+bool SoapyClientHandler::handleCall(const SoapyRemoteCalls call, SoapyRPCUnpacker &unpacker, SoapyRPCPacker &packer)
+{
     switch (call)
     {
 
@@ -144,6 +226,40 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         packer & SOAPY_REMOTE_VOID;
     } break;
 
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_BATCH:
+    ////////////////////////////////////////////////////////////////////
+    {
+        //handle the calls in order and pack each result,
+        //the first error ends the batch and the rest is discarded
+        int numCalls = 0;
+        unpacker & numCalls;
+        if (numCalls < 1 or size_t(numCalls) > unpacker.remaining()/BATCH_MIN_CALL_BYTES)
+        {
+            throw std::runtime_error("SoapyRemote::batch() call count "+std::to_string(numCalls)+" does not fit the message");
+        }
+        for (int i = 0; i < numCalls; i++)
+        {
+            try
+            {
+                //a batch does not nest and holds no factory, stream, or push calls
+                SoapyRemoteCalls batchCall;
+                unpacker & batchCall;
+                if (not isBatchCall(batchCall))
+                {
+                    throw std::runtime_error("SoapyRemote::batch() call "+std::to_string(int(batchCall))+" cannot be batched");
+                }
+                this->handleCall(batchCall, unpacker, packer);
+            }
+            catch (const std::exception &ex)
+            {
+                packer & ex;
+                unpacker.discard();
+                break;
+            }
+        }
+    } break;
+
     ////////////////////////////////////////////////////////////////////
     case SOAPY_REMOTE_GET_SERVER_ID:
     ////////////////////////////////////////////////////////////////////
@@ -320,6 +436,54 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         if (protIt != args.end()) prot = protIt->second;
         const bool datagramMode = (prot == "udp");
 
+        long maxLatencyUs = 0;
+        const auto maxLatencyIt = args.find(SOAPY_REMOTE_KWARG_MAX_LATENCY);
+        if (maxLatencyIt != args.end()) maxLatencyUs = std::stol(maxLatencyIt->second);
+
+        bool scheduleBursts = false;
+        const auto scheduleIt = args.find(SOAPY_REMOTE_KWARG_SCHEDULE);
+        if (scheduleIt != args.end()) scheduleBursts = (scheduleIt->second == "true");
+
+        long scheduleLeadUs = SOAPY_REMOTE_DEFAULT_SCHEDULE_LEAD_US;
+        const auto scheduleLeadIt = args.find(SOAPY_REMOTE_KWARG_SCHEDULE_LEAD);
+        if (scheduleLeadIt != args.end()) scheduleLeadUs = std::stol(scheduleLeadIt->second);
+
+        //the server converts the device format into the wire format
+        std::string wireFormat = format;
+        double scaleFactor = 0.0;
+        const ConvertKernel *convertKernel = nullptr;
+        const auto convertIt = args.find(SOAPY_REMOTE_KWARG_CONVERT);
+        if (convertIt != args.end() and convertIt->second == "server")
+        {
+            const auto wireFormatIt = args.find(SOAPY_REMOTE_KWARG_WIRE_FORMAT);
+            if (wireFormatIt != args.end()) wireFormat = wireFormatIt->second;
+            const auto scaleFactorIt = args.find(SOAPY_REMOTE_KWARG_SCALE);
+            if (scaleFactorIt != args.end()) scaleFactor = std::stod(scaleFactorIt->second);
+            convertKernel = findConvertKernel(wireFormat, format);
+            if (convertKernel == nullptr) throw std::runtime_error(
+                "SoapyRemote::setupStream() server conversion not supported;"
+                "wireFormat="+wireFormat+", format="+format);
+            SoapySDR::logf(SOAPY_SDR_INFO, "Server side conversion %s -> %s (%s)",
+                format.c_str(), wireFormat.c_str(), convertKernel->isa);
+            if (convertKernel->recv == nullptr) convertKernel = nullptr; //same format
+        }
+
+        //the payload codec applies to the format on the network
+        std::string compress = "none";
+        const auto compressIt = args.find(SOAPY_REMOTE_KWARG_COMPRESS);
+        if (compressIt != args.end()) compress = compressIt->second;
+        if (compress != "none" and not SoapyStreamCodec::isSupported(compress, wireFormat)) throw std::runtime_error(
+            "SoapyRemote::setupStream() compression not supported;"
+            "compress="+compress+", wireFormat="+wireFormat);
+
+        //the adaptive wire format narrows a CS16 format on the network
+        bool adaptive = false;
+        const auto adaptIt = args.find(SOAPY_REMOTE_KWARG_ADAPT);
+        if (adaptIt != args.end()) adaptive = (adaptIt->second == "true");
+        if (adaptive and (wireFormat != SOAPY_SDR_CS16 or compress != "none")) throw std::runtime_error(
+            "SoapyRemote::setupStream() adaptive wire format not supported;"
+            "wireFormat="+wireFormat+", compress="+compress);
+
         //create stream
         auto stream = _dev->setupStream(direction, format, channels, args);
 
@@ -331,6 +495,11 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         data.format = format;
         for (const auto chan : channels) data.chanMask |= (1 << chan);
         data.priority = priority;
+        data.maxLatencyUs = maxLatencyUs;
+        data.scheduleBursts = scheduleBursts and direction == SOAPY_SDR_TX;
+        data.scheduleLeadUs = scheduleLeadUs;
+        data.convertKernel = convertKernel;
+        data.scaleFactor = scaleFactor;
 
         //extract socket node information
         const auto localNode = SoapyURL(_sock.getsockname()).getNode();
@@ -411,11 +580,14 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         //create endpoint
         data.endpoint = new SoapyStreamEndpoint(*data.streamSock, *data.statusSock,
             datagramMode, direction == SOAPY_SDR_TX, channels.size(),
-            SoapySDR::formatToSize(format), mtu, window);
+            SoapySDR::formatToSize(wireFormat), mtu, window);
+        if (compress != "none") data.endpoint->enableCodec(compress, wireFormat);
+        if (adaptive) data.endpoint->enableAdaptive(wireFormat);
 
-        //start worker thread, this is not backwards,
+        //start worker thread or shared reactor, this is not backwards,
         //receive from device means using a send endpoint
         //transmit to device means using a recv endpoint
+        data.reactor = _reactor;
         if (direction == SOAPY_SDR_RX) data.startSendThread();
         if (direction == SOAPY_SDR_TX) data.startRecvThread();
         data.startStatThread();
@@ -1222,6 +1394,41 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         packer & SOAPY_REMOTE_VOID;
     } break;
 
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_QUEUE_COMMANDS:
+    ////////////////////////////////////////////////////////////////////
+    {
+        SoapySDR::KwargsList commands;
+        unpacker & commands;
+        delete _commandExecutor;
+        _commandExecutor = nullptr;
+        _commandExecutor = new SoapyCommandExecutor(_sock, _dev, commands);
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_REPEAT_COMMANDS:
+    ////////////////////////////////////////////////////////////////////
+    {
+        SoapySDR::KwargsList commands;
+        long long periodNs = 0;
+        unpacker & commands;
+        unpacker & periodNs;
+        delete _commandExecutor;
+        _commandExecutor = nullptr;
+        _commandExecutor = new SoapyCommandExecutor(_sock, _dev, commands, periodNs);
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_CANCEL_COMMANDS:
+    ////////////////////////////////////////////////////////////////////
+    {
+        delete _commandExecutor;
+        _commandExecutor = nullptr;
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
     ////////////////////////////////////////////////////////////////////
     case SOAPY_REMOTE_LIST_SENSORS:
     ////////////////////////////////////////////////////////////////////
@@ -1284,6 +1491,27 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         packer & _dev->readSensor(direction, channel, name);
     } break;
 
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_SUBSCRIBE_SENSORS:
+    ////////////////////////////////////////////////////////////////////
+    {
+        SoapySDR::KwargsList subscriptions;
+        unpacker & subscriptions;
+        delete _sensorPublisher;
+        _sensorPublisher = nullptr;
+        _sensorPublisher = new SoapySensorPublisher(_sock, _dev, subscriptions);
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_UNSUBSCRIBE_SENSORS:
+    ////////////////////////////////////////////////////////////////////
+    {
+        delete _sensorPublisher;
+        _sensorPublisher = nullptr;
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
     ////////////////////////////////////////////////////////////////////
     case SOAPY_REMOTE_WRITE_REGISTER:
     ////////////////////////////////////////////////////////////////////
@@ -1386,6 +1614,16 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         #endif
     } break;
 
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_RUN_SCRIPT:
+    ////////////////////////////////////////////////////////////////////
+    {
+        SoapySDR::KwargsList ops;
+        unpacker & ops;
+        SoapyScriptRunner runner(_dev, ops);
+        packer & runner.run();
+    } break;
+
     ////////////////////////////////////////////////////////////////////
     case SOAPY_REMOTE_GET_SETTING_INFO:
     ////////////////////////////////////////////////////////////////////
@@ -1609,6 +1847,27 @@ bool SoapyClientHandler::handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &
         packer & _dev->readUART(which, long(timeoutUs));
     } break;
 
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_START_SWEEP:
+    ////////////////////////////////////////////////////////////////////
+    {
+        SoapySDR::Kwargs plan;
+        unpacker & plan;
+        delete _sweepEngine;
+        _sweepEngine = nullptr;
+        _sweepEngine = new SoapySweepEngine(_sock, _dev, plan);
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
+    ////////////////////////////////////////////////////////////////////
+    case SOAPY_REMOTE_STOP_SWEEP:
+    ////////////////////////////////////////////////////////////////////
+    {
+        delete _sweepEngine;
+        _sweepEngine = nullptr;
+        packer & SOAPY_REMOTE_VOID;
+    } break;
+
     default: throw std::runtime_error(
         "SoapyClientHandler::handleOnce("+std::to_string(int(call))+") unknown call");
     }
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #pragma once
+#include "SoapyRemoteDefs.hpp"
 #include <cstddef>
 #include <string>
 #include <map>
@@ -10,7 +11,11 @@ class SoapyRPCSocket;
 class SoapyRPCPacker;
 class SoapyRPCUnpacker;
 class SoapyLogForwarder;
+class SoapySensorPublisher;
+class SoapyCommandExecutor;
+class SoapySweepEngine;
 class ServerStreamData;
+class ServerStreamReactor;
 
 namespace SoapySDR
 {
@@ -23,7 +28,7 @@ namespace SoapySDR
 class SoapyClientHandler
 {
 public:
-    SoapyClientHandler(SoapyRPCSocket &sock, const std::string &uuid);
+    SoapyClientHandler(SoapyRPCSocket &sock, const std::string &uuid, ServerStreamReactor *reactor);
 
     ~SoapyClientHandler(void);
 
@@ -33,10 +38,16 @@ public:
 private:
     bool handleOnce(SoapyRPCUnpacker &unpacker, SoapyRPCPacker &packer);
 
+    bool handleCall(const SoapyRemoteCalls call, SoapyRPCUnpacker &unpacker, SoapyRPCPacker &packer);
+
     SoapyRPCSocket &_sock;
     const std::string _uuid;
+    ServerStreamReactor *_reactor;
     SoapySDR::Device *_dev;
     SoapyLogForwarder *_logForwarder;
+    SoapySensorPublisher *_sensorPublisher;
+    SoapyCommandExecutor *_commandExecutor;
+    SoapySweepEngine *_sweepEngine;
 
     //stream tracking
     int _nextStreamId;
@@ -0,0 +1,186 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "CommandExecutor.hpp"
+#include "SoapyRemoteDefs.hpp"
+#include "SoapyRPCSocket.hpp"
+#include "SoapyRPCPacker.hpp"
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <stdexcept>
+#include <algorithm> //stable_sort
+#include <chrono>
+
+//! Spin on the hardware time for the last part of the wait
+static const long long SPIN_WAIT_NS = 1000000; //1 ms
+
+static bool isCommandCall(const std::string &call)
+{
+    return call == "setFrequency" or call == "setGain" or call == "setAntenna" or
+        call == "setSampleRate" or call == "setBandwidth" or call == "writeSetting";
+}
+
+static std::string commandArg(const SoapySDR::Kwargs &command, const std::string &key)
+{
+    const auto it = command.find(key);
+    return (it == command.end())?"":it->second;
+}
+
+SoapyCommandExecutor::SoapyCommandExecutor(SoapyRPCSocket &sock, SoapySDR::Device *device,
+    const SoapySDR::KwargsList &commands, const long long periodNs):
+    _sock(sock),
+    _device(device),
+    _periodNs(periodNs),
+    _done(false)
+{
+    if (_device == nullptr) throw std::runtime_error("SoapyCommandExecutor() no device");
+    if (_periodNs < 0) throw std::runtime_error("SoapyCommandExecutor() negative period");
+
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        const auto &args = commands[i];
+        if (not isCommandCall(commandArg(args, "call"))) throw std::runtime_error(
+            "SoapyCommandExecutor() unknown call '"+commandArg(args, "call")+"' in command "+std::to_string(i));
+        Command command;
+        //commands can share the index of their hop in a table
+        command.index = commandArg(args, "index").empty()?int(i):std::stoi(args.at("index"));
+        command.timeNs = std::stoll(args.at("time"));
+        command.commandTime = (commandArg(args, "command") == "true");
+        command.args = args;
+        _commands.push_back(command);
+    }
+
+    //execute in time order, commands at the same time in upload order
+    std::stable_sort(_commands.begin(), _commands.end(),
+        [](const Command &a, const Command &b){return a.timeNs < b.timeNs;});
+}
+
+SoapyCommandExecutor::~SoapyCommandExecutor(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _cond.notify_one();
+    if (_thread.joinable()) _thread.join();
+}
+
+void SoapyCommandExecutor::start(void)
+{
+    if (_thread.joinable()) return;
+    _thread = std::thread(&SoapyCommandExecutor::executeLoop, this);
+}
+
+bool SoapyCommandExecutor::waitTime(std::unique_lock<std::mutex> &lock, const long long timeNs)
+{
+    while (not _done)
+    {
+        const long long remaining = timeNs - _device->getHardwareTime();
+        if (remaining <= 0) return true;
+
+        //sleep until close to the time, then spin for precision
+        if (remaining > SPIN_WAIT_NS) _cond.wait_for(lock, std::chrono::nanoseconds(remaining-SPIN_WAIT_NS));
+        else
+        {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
+    return false;
+}
+
+void SoapyCommandExecutor::execute(const SoapySDR::Kwargs &command)
+{
+    const std::string call = commandArg(command, "call");
+    const std::string name = commandArg(command, "name");
+    const std::string value = commandArg(command, "value");
+    const std::string dirArg = commandArg(command, "direction");
+    const std::string chanArg = commandArg(command, "channel");
+    const int direction = dirArg.empty()?SOAPY_SDR_RX:std::stoi(dirArg);
+    const size_t channel = chanArg.empty()?0:std::stoul(chanArg);
+
+    if (call == "setFrequency")
+    {
+        if (name.empty()) _device->setFrequency(direction, channel, std::stod(value));
+        else _device->setFrequency(direction, channel, name, std::stod(value));
+    }
+    else if (call == "setGain")
+    {
+        if (name.empty()) _device->setGain(direction, channel, std::stod(value));
+        else _device->setGain(direction, channel, name, std::stod(value));
+    }
+    else if (call == "setAntenna") _device->setAntenna(direction, channel, name);
+    else if (call == "setSampleRate") _device->setSampleRate(direction, channel, std::stod(value));
+    else if (call == "setBandwidth") _device->setBandwidth(direction, channel, std::stod(value));
+    else if (call == "writeSetting")
+    {
+        if (chanArg.empty()) _device->writeSetting(name, value);
+        else _device->writeSetting(direction, channel, name, value);
+    }
+}
+
+void SoapyCommandExecutor::executeLoop(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    try
+    {
+        //repeat the commands every period until stopped
+        long long prevTimeNs = 0;
+        long long groupTimeNs = 0;
+        long long offsetNs = 0;
+        while (this->executeOnce(lock, offsetNs, prevTimeNs, groupTimeNs) and _periodNs != 0)
+        {
+            offsetNs += _periodNs;
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        //the client or the device clock went away, stop executing
+        SoapySDR::logf(SOAPY_SDR_ERROR, "SoapyCommandExecutor::executeLoop() FAIL: %s", ex.what());
+    }
+}
+
+bool SoapyCommandExecutor::executeOnce(std::unique_lock<std::mutex> &lock, const long long offsetNs, long long &prevTimeNs, long long &groupTimeNs)
+{
+    for (const auto &command : _commands)
+    {
+        //commands at the same time form a group, such as the calls of a hop
+        const long long commandTimeNs = command.timeNs + offsetNs;
+        if (commandTimeNs != groupTimeNs)
+        {
+            prevTimeNs = groupTimeNs;
+            groupTimeNs = commandTimeNs;
+        }
+
+        //with the device command time the command is issued right away,
+        //when repeating it is issued at the time of the group before it
+        long long waitTimeNs = commandTimeNs;
+        if (command.commandTime) waitTimeNs = (_periodNs == 0)?0:prevTimeNs;
+        if (waitTimeNs != 0 and not this->waitTime(lock, waitTimeNs)) return false;
+        if (_done) return false;
+
+        long long timeNs = commandTimeNs;
+        std::string errorMsg;
+        try
+        {
+            if (command.commandTime) _device->setCommandTime(commandTimeNs);
+            else timeNs = _device->getHardwareTime();
+            this->execute(command.args);
+            if (command.commandTime) _device->setCommandTime(0);
+        }
+        catch (const std::exception &ex)
+        {
+            errorMsg = ex.what();
+            if (errorMsg.empty()) errorMsg = "unknown error";
+            if (command.commandTime) _device->setCommandTime(0);
+        }
+
+        SoapyRPCPacker packer(_sock);
+        packer & command.index;
+        packer & timeNs;
+        packer & errorMsg;
+        packer();
+    }
+    return not _commands.empty();
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class SoapyRPCSocket;
+
+namespace SoapySDR
+{
+    class Device;
+}
+
+/*!
+ * The command executor runs a queue of timed commands in a thread.
+ * Each command waits for its time on the device hardware clock,
+ * or is issued right away with the device command time set.
+ * With a period the commands repeat, such as for a hopping table,
+ * and a command with the device command time is issued
+ * at the time of the commands before it with a different time.
+ * A report is pushed over the socket for every command,
+ * with the command index, the hardware time when it was issued,
+ * and the error message or an empty string on success.
+ */
+class SoapyCommandExecutor
+{
+public:
+    SoapyCommandExecutor(SoapyRPCSocket &sock, SoapySDR::Device *device,
+        const SoapySDR::KwargsList &commands, const long long periodNs = 0);
+
+    ~SoapyCommandExecutor(void);
+
+    //! Start executing, call after the reply to the upload was sent
+    void start(void);
+
+private:
+    void executeLoop(void);
+
+    //execute every command once at the offset, false when stopped,
+    //tracks the time of the command group before the current one
+    bool executeOnce(std::unique_lock<std::mutex> &lock, const long long offsetNs, long long &prevTimeNs, long long &groupTimeNs);
+
+    //wait for the hardware time, false when stopped
+    bool waitTime(std::unique_lock<std::mutex> &lock, const long long timeNs);
+
+    void execute(const SoapySDR::Kwargs &command);
+
+    struct Command
+    {
+        int index;
+        long long timeNs;
+        bool commandTime;
+        SoapySDR::Kwargs args;
+    };
+
+    SoapyRPCSocket &_sock;
+    SoapySDR::Device *_device;
+    std::vector<Command> _commands;
+    long long _periodNs;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _done;
+};
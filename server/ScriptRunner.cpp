@@ -0,0 +1,161 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ScriptRunner.hpp"
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Version.hpp>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <cstdio> //snprintf
+
+static std::string opArg(const SoapySDR::Kwargs &op, const std::string &key, const std::string &def = "")
+{
+    const auto it = op.find(key);
+    if (it != op.end()) return it->second;
+    if (def.empty()) throw std::runtime_error("missing "+key);
+    return def;
+}
+
+//numbers in decimal or with a 0x prefix for hex
+static unsigned opNumber(const SoapySDR::Kwargs &op, const std::string &key, const std::string &def = "")
+{
+    return unsigned(std::stoul(opArg(op, key, def), nullptr, 0));
+}
+
+static std::string toHex(const unsigned value)
+{
+    char buff[16];
+    std::snprintf(buff, sizeof(buff), "0x%x", value);
+    return buff;
+}
+
+//i2c data as a string of hex bytes without a prefix
+static std::string bytesFromHex(const std::string &hex)
+{
+    if (hex.size() % 2 != 0) throw std::runtime_error("odd length hex data "+hex);
+    std::string bytes;
+    for (size_t i = 0; i < hex.size(); i += 2) bytes.push_back(char(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    return bytes;
+}
+
+static std::string bytesToHex(const std::string &bytes)
+{
+    std::string hex;
+    char buff[4];
+    for (const auto byte : bytes)
+    {
+        std::snprintf(buff, sizeof(buff), "%02x", unsigned(static_cast<unsigned char>(byte)));
+        hex += buff;
+    }
+    return hex;
+}
+
+SoapyScriptRunner::SoapyScriptRunner(SoapySDR::Device *device, const SoapySDR::KwargsList &ops):
+    _device(device),
+    _ops(ops)
+{
+    if (_device == nullptr) throw std::runtime_error("SoapyScriptRunner() no device");
+}
+
+std::vector<std::string> SoapyScriptRunner::run(void)
+{
+    std::vector<std::string> results;
+    for (size_t i = 0; i < _ops.size(); i++)
+    {
+        try
+        {
+            this->runOp(_ops[i], results);
+        }
+        catch (const std::exception &ex)
+        {
+            throw std::runtime_error("SoapyRemote::runScript() op "+std::to_string(i)+": "+ex.what());
+        }
+    }
+    return results;
+}
+
+unsigned SoapyScriptRunner::readRegister(const SoapySDR::Kwargs &op) const
+{
+    const unsigned addr = opNumber(op, "addr");
+    if (op.count("iface") == 0) return _device->readRegister(addr);
+    #ifdef SOAPY_SDR_API_HAS_NAMED_REGISTER_API
+    return _device->readRegister(op.at("iface"), addr);
+    #else
+    throw std::runtime_error("named registers not supported");
+    #endif
+}
+
+void SoapyScriptRunner::writeRegister(const SoapySDR::Kwargs &op, const unsigned value)
+{
+    const unsigned addr = opNumber(op, "addr");
+    if (op.count("iface") == 0)
+    {
+        _device->writeRegister(addr, value);
+        return;
+    }
+    #ifdef SOAPY_SDR_API_HAS_NAMED_REGISTER_API
+    _device->writeRegister(op.at("iface"), addr, value);
+    #else
+    throw std::runtime_error("named registers not supported");
+    #endif
+}
+
+void SoapyScriptRunner::runOp(const SoapySDR::Kwargs &op, std::vector<std::string> &results)
+{
+    const std::string name = opArg(op, "op");
+    const unsigned mask = opNumber(op, "mask", "0xffffffff");
+
+    if (name == "write")
+    {
+        //read-modify-write when only the masked bits change
+        unsigned value = opNumber(op, "value");
+        if (op.count("mask") != 0) value = (this->readRegister(op) & ~mask) | (value & mask);
+        this->writeRegister(op, value);
+    }
+    else if (name == "read")
+    {
+        results.push_back(toHex(this->readRegister(op) & mask));
+    }
+    else if (name == "poll")
+    {
+        //poll a register or a gpio bank until the masked bits match,
+        //the interval keeps a slow bus from being flooded with reads
+        const unsigned value = opNumber(op, "value") & mask;
+        const auto timeout = std::chrono::microseconds(opNumber(op, "timeout_us", "1000000"));
+        const auto interval = std::chrono::microseconds(opNumber(op, "interval_us", "1000"));
+        const auto exitTime = std::chrono::steady_clock::now() + timeout;
+        const bool isGPIO = (op.count("bank") != 0);
+        while (((isGPIO?_device->readGPIO(op.at("bank")):this->readRegister(op)) & mask) != value)
+        {
+            if (std::chrono::steady_clock::now() > exitTime) throw std::runtime_error("poll timeout");
+            std::this_thread::sleep_for(interval);
+        }
+    }
+    else if (name == "wait")
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(opNumber(op, "us")));
+    }
+    else if (name == "gpio_write")
+    {
+        if (op.count("mask") != 0) _device->writeGPIO(opArg(op, "bank"), opNumber(op, "value"), mask);
+        else _device->writeGPIO(opArg(op, "bank"), opNumber(op, "value"));
+    }
+    else if (name == "gpio_read")
+    {
+        results.push_back(toHex(_device->readGPIO(opArg(op, "bank")) & mask));
+    }
+    else if (name == "i2c_write")
+    {
+        _device->writeI2C(int(opNumber(op, "addr")), bytesFromHex(opArg(op, "data")));
+    }
+    else if (name == "i2c_read")
+    {
+        results.push_back(bytesToHex(_device->readI2C(int(opNumber(op, "addr")), opNumber(op, "len"))));
+    }
+    else if (name == "spi")
+    {
+        results.push_back(toHex(_device->transactSPI(int(opNumber(op, "addr")), opNumber(op, "data"), opNumber(op, "bits"))));
+    }
+    else throw std::runtime_error("unknown op "+name);
+}
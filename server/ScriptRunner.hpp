@@ -0,0 +1,37 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <vector>
+
+namespace SoapySDR
+{
+    class Device;
+}
+
+/*!
+ * The script runner executes a transaction script on the device
+ * within one call, such as the register accesses of a bring-up.
+ * Every operation is markup with an op key, see remote:script.
+ * The script stops at the first operation that fails,
+ * with the index of the operation in the error message.
+ */
+class SoapyScriptRunner
+{
+public:
+    SoapyScriptRunner(SoapySDR::Device *device, const SoapySDR::KwargsList &ops);
+
+    //! Run the script and get the results of the read operations in order
+    std::vector<std::string> run(void);
+
+private:
+    void runOp(const SoapySDR::Kwargs &op, std::vector<std::string> &results);
+
+    unsigned readRegister(const SoapySDR::Kwargs &op) const;
+    void writeRegister(const SoapySDR::Kwargs &op, const unsigned value);
+
+    SoapySDR::Device *_device;
+    const SoapySDR::KwargsList _ops;
+};
@@ -0,0 +1,102 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SensorPublisher.hpp"
+#include "SoapyRemoteDefs.hpp"
+#include "SoapyRPCSocket.hpp"
+#include "SoapyRPCPacker.hpp"
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <stdexcept>
+#include <algorithm> //min
+
+SoapySensorPublisher::SoapySensorPublisher(SoapyRPCSocket &sock, SoapySDR::Device *device, const SoapySDR::KwargsList &subscriptions):
+    _sock(sock),
+    _device(device),
+    _done(false)
+{
+    if (_device == nullptr) throw std::runtime_error("SoapySensorPublisher() no device");
+
+    for (const auto &args : subscriptions)
+    {
+        Subscription sub;
+        sub.direction = std::stoi(args.at("direction"));
+        sub.channel = std::stoi(args.at("channel"));
+        sub.name = args.at("name");
+        sub.period = std::chrono::microseconds(std::max(1000L, std::stol(args.at("period_us"))));
+        sub.onChange = (args.at("on_change") == "true");
+        sub.valid = false;
+        _subscriptions.push_back(sub);
+    }
+}
+
+SoapySensorPublisher::~SoapySensorPublisher(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _cond.notify_one();
+    if (_thread.joinable()) _thread.join();
+}
+
+void SoapySensorPublisher::start(void)
+{
+    if (_thread.joinable()) return;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto &sub : _subscriptions) sub.nextTime = now;
+    _thread = std::thread(&SoapySensorPublisher::publishLoop, this);
+}
+
+void SoapySensorPublisher::publishLoop(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _done)
+    {
+        //sample the sensors that are due into one update message
+        const auto now = std::chrono::steady_clock::now();
+        auto nextTime = now + std::chrono::seconds(1);
+        SoapyRPCPacker packer(_sock);
+        bool hasUpdates = false;
+        for (auto &sub : _subscriptions)
+        {
+            if (sub.nextTime <= now)
+            {
+                sub.nextTime = std::max(sub.nextTime + sub.period, now);
+                std::string value;
+                try
+                {
+                    if (sub.direction < 0) value = _device->readSensor(sub.name);
+                    else value = _device->readSensor(sub.direction, sub.channel, sub.name);
+                }
+                catch (const std::exception &ex)
+                {
+                    SoapySDR::logf(SOAPY_SDR_DEBUG, "SoapySensorPublisher::readSensor(%s) FAIL: %s", sub.name.c_str(), ex.what());
+                    continue;
+                }
+                if (sub.onChange and sub.valid and value == sub.value) continue;
+                sub.valid = true;
+                sub.value = value;
+                packer & char(sub.direction);
+                packer & sub.channel;
+                packer & sub.name;
+                packer & value;
+                hasUpdates = true;
+            }
+            nextTime = std::min(nextTime, sub.nextTime);
+        }
+
+        if (hasUpdates) try
+        {
+            packer();
+        }
+        catch (const std::exception &ex)
+        {
+            //the client went away, stop sampling
+            SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySensorPublisher::publishLoop() FAIL: %s", ex.what());
+            return;
+        }
+
+        _cond.wait_until(lock, nextTime, [this]{return _done;});
+    }
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Types.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class SoapyRPCSocket;
+
+namespace SoapySDR
+{
+    class Device;
+}
+
+/*!
+ * The sensor publisher samples the subscribed sensors of a device
+ * in a background thread and pushes the updates over the socket.
+ * Each update message holds the direction (-1 for device sensors),
+ * channel, name, and value of every sensor that was sampled.
+ */
+class SoapySensorPublisher
+{
+public:
+    SoapySensorPublisher(SoapyRPCSocket &sock, SoapySDR::Device *device, const SoapySDR::KwargsList &subscriptions);
+
+    ~SoapySensorPublisher(void);
+
+    //! Start pushing, call after the reply to the subscription was sent
+    void start(void);
+
+private:
+    void publishLoop(void);
+
+    struct Subscription
+    {
+        int direction;
+        int channel;
+        std::string name;
+        std::chrono::microseconds period;
+        bool onChange;
+        std::chrono::steady_clock::time_point nextTime;
+        bool valid;
+        std::string value;
+    };
+
+    SoapyRPCSocket &_sock;
+    SoapySDR::Device *_device;
+    std::vector<Subscription> _subscriptions;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _done;
+};
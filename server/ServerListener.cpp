@@ -14,7 +14,8 @@
 SoapyServerThreadData::SoapyServerThreadData(void):
     done(false),
     thread(nullptr),
-    client(nullptr)
+    client(nullptr),
+    reactor(nullptr)
 {
     return;
 }
@@ -36,7 +37,7 @@ SoapyServerThreadData::~SoapyServerThreadData(void)
 
 void SoapyServerThreadData::handlerLoop(void)
 {
-    SoapyClientHandler handler(*client, uuid);
+    SoapyClientHandler handler(*client, uuid, reactor);
 
     try
     {
@@ -56,9 +57,10 @@ void SoapyServerThreadData::handlerLoop(void)
 /***********************************************************************
  * Socket listener constructor
  **********************************************************************/
-SoapyServerListener::SoapyServerListener(SoapyRPCSocket &sock, const std::string &uuid):
+SoapyServerListener::SoapyServerListener(SoapyRPCSocket &sock, const std::string &uuid, ServerStreamReactor *reactor):
     _sock(sock),
     _uuid(uuid),
+    _reactor(reactor),
     _handlerId(0)
 {
     return;
@@ -102,6 +104,7 @@ void SoapyServerListener::handleOnce(void)
     auto &data = _handlers[_handlerId++];
     data.client = client;
     data.uuid = _uuid;
+    data.reactor = _reactor;
 
     //spawn a new thread
     data.thread = new std::thread(&SoapyServerThreadData::handlerLoop, &data);
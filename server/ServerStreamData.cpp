@@ -3,15 +3,22 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include "ServerStreamData.hpp"
+#include "ServerStreamReactor.hpp"
 #include "SoapyRemoteDefs.hpp"
 #include "SoapyStreamEndpoint.hpp"
+#include "SoapyStreamConvert.hpp"
 #include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
 #include <SoapySDR/Logger.hpp>
 #include <algorithm> //min
 #include <thread>
+#include <chrono>
 #include <vector>
 #include <cassert>
 
+//limit the memory held by the burst scheduler before applying back-pressure
+#define SCHEDULE_MAX_QUEUED_BYTES (64*1024*1024)
+
 template <typename T>
 void incrementBuffs(std::vector<T> &buffs, size_t numElems, size_t elemSize)
 {
@@ -30,6 +37,26 @@ ServerStreamData::ServerStreamData(void):
     streamSock(nullptr),
     statusSock(nullptr),
     endpoint(nullptr),
+    reactor(nullptr),
+    maxLatencyUs(0),
+    scheduleBursts(false),
+    scheduleLeadUs(SOAPY_REMOTE_DEFAULT_SCHEDULE_LEAD_US),
+    convertKernel(nullptr),
+    scaleFactor(0.0),
+    _sendHandle(0),
+    _sendElems(0),
+    _sendAcquired(false),
+    _mtuElems(0),
+    _deviceElemSize(0),
+    _directAccess(false),
+    _dmaHandle(0),
+    _dmaAcquired(false),
+    _dmaElemsLeft(0),
+    _dmaFlags(0),
+    _dmaTimeNs(0),
+    _openBurst(_burstQueue.end()),
+    _dropOpenBurst(false),
+    _queuedBytes(0),
     streamThread(nullptr),
     statusThread(nullptr),
     done(true)
@@ -46,14 +73,18 @@ ServerStreamData::~ServerStreamData(void)
 void ServerStreamData::startSendThread(void)
 {
     assert(streamId != -1);
+    this->resetWorkState();
     done = false;
+    if (reactor != nullptr) return reactor->add(this, false);
     streamThread = new std::thread(&ServerStreamData::sendEndpointWork, this);
 }
 
 void ServerStreamData::startRecvThread(void)
 {
     assert(streamId != -1);
+    this->resetWorkState();
     done = false;
+    if (reactor != nullptr) return reactor->add(this, true);
     streamThread = new std::thread(&ServerStreamData::recvEndpointWork, this);
 }
 
@@ -61,12 +92,17 @@ void ServerStreamData::startStatThread(void)
 {
     assert(streamId != -1);
     done = false;
+    if (reactor != nullptr) return; //added with the stream work
     statusThread = new std::thread(&ServerStreamData::statEndpointWork, this);
 }
 
 void ServerStreamData::stopThreads(void)
 {
     done = true;
+    if (reactor != nullptr)
+    {
+        reactor->remove(this);
+    }
     if (streamThread != nullptr)
     {
         streamThread->join();
@@ -77,6 +113,48 @@ void ServerStreamData::stopThreads(void)
         statusThread->join();
         delete statusThread;
     }
+
+    //return a partially forwarded read buffer to the driver
+    if (_dmaAcquired)
+    {
+        device->releaseReadBuffer(stream, _dmaHandle);
+        _dmaAcquired = false;
+    }
+}
+
+void ServerStreamData::resetWorkState(void)
+{
+    assert(endpoint != nullptr);
+    assert(endpoint->getElemSize() != 0);
+    assert(endpoint->getNumChans() != 0);
+
+    _recvBuffs.resize(endpoint->getNumChans());
+    _sendBuffs.resize(endpoint->getNumChans());
+    _sendAcquired = false;
+    _mtuElems = device->getStreamMTU(stream);
+    _deviceElemSize = SoapySDR::formatToSize(format);
+
+    //the server-side conversion stages the device format in these buffers
+    _convertStorage.clear();
+    _recvConvBuffs.resize(endpoint->getNumChans());
+    _sendConvBuffs.resize(endpoint->getNumChans());
+    if (convertKernel != nullptr)
+    {
+        _convertStorage.resize(endpoint->getNumChans(), std::vector<char>(endpoint->getBuffSize()*_deviceElemSize));
+    }
+
+    //forward directly from the driver's buffers when supported,
+    //features that hold, accumulate, or convert the samples use the copy path
+    _directAccess = device->getNumDirectAccessBuffers(stream) != 0;
+    if (scheduleBursts or maxLatencyUs != 0 or convertKernel != nullptr) _directAccess = false;
+    _dmaBuffs.resize(endpoint->getNumChans());
+    _dmaAcquired = false;
+
+    //reset the scheduler state
+    _burstQueue.clear();
+    _openBurst = _burstQueue.end();
+    _dropOpenBurst = false;
+    _queuedBytes = 0;
 }
 
 static void setThreadPrioWithLogging(const double priority)
@@ -89,156 +167,416 @@ static void setThreadPrioWithLogging(const double priority)
 void ServerStreamData::recvEndpointWork(void)
 {
     setThreadPrioWithLogging(priority);
-    assert(endpoint != nullptr);
-    assert(endpoint->getElemSize() != 0);
-    assert(endpoint->getNumChans() != 0);
 
-    //setup worker data structures
-    int ret = 0;
+    while (not done)
+    {
+        const auto result = this->recvEndpointOnce(SOAPY_REMOTE_SOCKET_TIMEOUT_US);
+        if (result == STREAM_WORK_EXIT) return;
+
+        //the scheduler is full, retry once the next burst is due
+        if (result == STREAM_WORK_IDLE) std::this_thread::sleep_until(scheduleDueTime);
+    }
+}
+
+StreamWorkResult ServerStreamData::recvEndpointOnce(const long timeoutUs)
+{
     size_t handle = 0;
     int flags = 0;
     long long timeNs = 0;
-    const auto elemSize = endpoint->getElemSize();
-    std::vector<const void *> buffs(endpoint->getNumChans());
 
-    //loop forever until signaled done
+    //one pass of the receive work
     //1) wait on the endpoint to become ready
     //2) acquire the recv buffer from the endpoint
     //3) write to the device stream from the endpoint buffer
+    //   or hold timed bursts in the scheduler until they are due
     //4) release the buffer back to the endpoint
+
+    //the scheduler limits the wait to the next due burst
+    long waitUs = timeoutUs;
+    if (scheduleBursts)
+    {
+        const long dueUs = this->dispatchDueBursts();
+        scheduleDueTime = std::chrono::steady_clock::now() + std::chrono::microseconds(dueUs);
+        waitUs = std::min(waitUs, dueUs);
+    }
+
+    //stop receiving when the scheduler is full, the caller retries
+    //when the next burst is due, the flow control will apply back-pressure to the client
+    if (_queuedBytes >= SCHEDULE_MAX_QUEUED_BYTES) return STREAM_WORK_IDLE;
+
+    if (not endpoint->waitRecv(waitUs)) return STREAM_WORK_WAIT;
+    if (_directAccess) return this->recvDirectOnce(timeoutUs);
+    const int ret = endpoint->acquireRecv(handle, _recvBuffs.data(), flags, timeNs);
+    if (ret < 0)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: %s; worker quitting...", streamSock->lastErrorMsg());
+        return STREAM_WORK_EXIT;
+    }
+
+    //convert from the wire format into the device format
+    auto *buffs = &_recvBuffs;
+    if (convertKernel != nullptr)
+    {
+        for (size_t i = 0; i < _recvBuffs.size(); i++)
+        {
+            convertKernel->send(_recvBuffs[i], _convertStorage[i].data(), size_t(ret), scaleFactor);
+            _recvConvBuffs[i] = _convertStorage[i].data();
+        }
+        buffs = &_recvConvBuffs;
+    }
+
+    if (scheduleBursts) this->scheduleRecvBuffs(*buffs, size_t(ret), flags, timeNs);
+    else this->writeDeviceBuffs(*buffs, size_t(ret), flags, timeNs);
+
+    //release the buffer back to the endpoint
+    endpoint->releaseRecv(handle);
+    return STREAM_WORK_AGAIN;
+}
+
+StreamWorkResult ServerStreamData::recvDirectOnce(const long timeoutUs)
+{
+    size_t handle = 0;
+    int flags = 0;
+    long long timeNs = 0;
+
+    //the datagram is received straight into the driver's write buffer
+    int ret = device->acquireWriteBuffer(stream, handle, _dmaBuffs.data(), timeoutUs);
+    if (ret == SOAPY_SDR_TIMEOUT) return STREAM_WORK_IDLE;
+
+    //fall back to the copy path when the driver buffer cannot hold a datagram
+    if (ret == SOAPY_SDR_NOT_SUPPORTED or (ret >= 0 and size_t(ret) < endpoint->getBuffSize()))
+    {
+        if (ret >= 0) device->releaseWriteBuffer(stream, handle, 0, flags);
+        SoapySDR::logf(SOAPY_SDR_DEBUG, "Server-side receive endpoint: direct buffer access unavailable (%d)", ret);
+        _directAccess = false;
+        return STREAM_WORK_AGAIN;
+    }
+
+    //other errors are reported to the remote endpoint,
+    //and the datagram is discarded like after a failed write
+    if (ret < 0)
+    {
+        endpoint->writeStatus(ret, chanMask, 0, 0);
+        if (endpoint->acquireRecv(handle, _recvBuffs.data(), flags, timeNs) < 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: %s; worker quitting...", streamSock->lastErrorMsg());
+            return STREAM_WORK_EXIT;
+        }
+        endpoint->releaseRecv(handle);
+        return STREAM_WORK_AGAIN;
+    }
+
+    ret = endpoint->recvBuffs(_dmaBuffs.data(), flags, timeNs);
+    if (ret < 0)
+    {
+        device->releaseWriteBuffer(stream, handle, 0, flags);
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: %s; worker quitting...", streamSock->lastErrorMsg());
+        return STREAM_WORK_EXIT;
+    }
+
+    device->releaseWriteBuffer(stream, handle, size_t(ret), flags, timeNs);
+    return STREAM_WORK_AGAIN;
+}
+
+void ServerStreamData::writeDeviceBuffs(std::vector<const void *> &buffs, const size_t numElems, int flags, const long long timeNs)
+{
+    const auto elemSize = _deviceElemSize;
+
+    //loop to write to device
+    size_t elemsLeft = numElems;
     while (not done)
     {
-        if (not endpoint->waitRecv(SOAPY_REMOTE_SOCKET_TIMEOUT_US)) continue;
-        ret = endpoint->acquireRecv(handle, buffs.data(), flags, timeNs);
+        int ret = device->writeStream(stream, buffs.data(), elemsLeft, flags, timeNs, SOAPY_REMOTE_SOCKET_TIMEOUT_US);
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
         if (ret < 0)
         {
-            SoapySDR::logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: %s; worker quitting...", streamSock->lastErrorMsg());
-            return;
+            endpoint->writeStatus(ret, chanMask, flags, timeNs);
+            break; //discard after error, this may have been invalid flags or time
+        }
+        if (elemsLeft < (size_t)ret)
+        {
+            SoapySDR_logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: device->writeStream wrote more elements than requested");
+            break; //stop after error
         }
+        elemsLeft -= ret;
+        incrementBuffs(buffs, ret, elemSize);
+        if (elemsLeft == 0) break;
+        flags &= ~(SOAPY_SDR_HAS_TIME); //clear time for subsequent writes
+    }
+}
+
+/***********************************************************************
+ * Transmit burst scheduler:
+ * Timed bursts are copied into a queue ordered by time,
+ * and written to the device once they are within the lead time.
+ * A burst that is already late when it comes due is not written,
+ * it is dropped and reported to the client with a time error.
+ * A burst that has not ended when written continues to the device.
+ **********************************************************************/
+void ServerStreamData::scheduleRecvBuffs(const std::vector<const void *> &buffs, const size_t numElems, const int flags, const long long timeNs)
+{
+    const bool endBurst = (flags & SOAPY_SDR_END_BURST) != 0;
+
+    //a timed buffer starts a new burst in the queue
+    if ((flags & SOAPY_SDR_HAS_TIME) != 0)
+    {
+        _dropOpenBurst = false;
 
-        //loop to write to device
-        size_t elemsLeft = size_t(ret);
-        while (not done)
+        auto it = _burstQueue.insert(std::make_pair(timeNs, ScheduledBurst()));
+        auto &burst = it->second;
+        burst.flags = flags;
+        burst.timeNs = timeNs;
+        burst.numElems = 0;
+        burst.buffs.resize(buffs.size());
+        this->appendBurst(burst, buffs, numElems);
+        _openBurst = endBurst?_burstQueue.end():it;
+    }
+
+    //continuation of a burst that is still queued
+    else if (_openBurst != _burstQueue.end())
+    {
+        auto &burst = _openBurst->second;
+        this->appendBurst(burst, buffs, numElems);
+        burst.flags |= flags;
+        if (endBurst) _openBurst = _burstQueue.end();
+    }
+
+    //continuation of a late burst that was dropped
+    else if (_dropOpenBurst)
+    {
+        if (endBurst) _dropOpenBurst = false;
+    }
+
+    //untimed buffers and continuations of dispatched bursts
+    else
+    {
+        auto writeBuffs = buffs;
+        this->writeDeviceBuffs(writeBuffs, numElems, flags, timeNs);
+    }
+}
+
+void ServerStreamData::appendBurst(ScheduledBurst &burst, const std::vector<const void *> &buffs, const size_t numElems)
+{
+    const size_t numBytes = numElems*_deviceElemSize;
+    for (size_t i = 0; i < buffs.size(); i++)
+    {
+        const char *p = (const char *)buffs[i];
+        burst.buffs[i].insert(burst.buffs[i].end(), p, p+numBytes);
+    }
+    burst.numElems += numElems;
+    _queuedBytes += numBytes*buffs.size();
+}
+
+long ServerStreamData::dispatchDueBursts(void)
+{
+    const long long leadNs = (long long)(scheduleLeadUs)*1000;
+    while (not _burstQueue.empty())
+    {
+        auto it = _burstQueue.begin();
+        auto &burst = it->second;
+
+        //the earliest burst is not due yet, wait at most until then
+        const long long hwTimeNs = device->getHardwareTime();
+        if (burst.timeNs > hwTimeNs + leadNs)
         {
-            ret = device->writeStream(stream, buffs.data(), elemsLeft, flags, timeNs, SOAPY_REMOTE_SOCKET_TIMEOUT_US);
-            if (ret == SOAPY_SDR_TIMEOUT) continue;
-            if (ret < 0)
-            {
-                endpoint->writeStatus(ret, chanMask, flags, timeNs);
-                break; //discard after error, this may have been invalid flags or time
-            }
-            if (elemsLeft < (size_t)ret)
-            {
-                SoapySDR_logf(SOAPY_SDR_ERROR, "Server-side receive endpoint: device->writeStream wrote more elements than requested");
-                break; //stop after error
-            }
-            elemsLeft -= ret;
-            incrementBuffs(buffs, ret, elemSize);
-            if (elemsLeft == 0) break;
-            flags &= ~(SOAPY_SDR_HAS_TIME); //clear time for subsequent writes
+            const long long waitUs = (burst.timeNs - leadNs - hwTimeNs)/1000;
+            return long(std::min<long long>(waitUs, SOAPY_REMOTE_SOCKET_TIMEOUT_US));
         }
 
-        //release the buffer back to the endpoint
-        endpoint->releaseRecv(handle);
+        //late bursts are reported without spending any device time
+        const bool isOpen = (it == _openBurst);
+        if (burst.timeNs <= hwTimeNs)
+        {
+            endpoint->writeStatus(SOAPY_SDR_TIME_ERROR, chanMask, burst.flags, burst.timeNs);
+            _dropOpenBurst = isOpen;
+        }
+        else
+        {
+            std::vector<const void *> buffs;
+            for (const auto &buff : burst.buffs) buffs.push_back(buff.data());
+            this->writeDeviceBuffs(buffs, burst.numElems, burst.flags, burst.timeNs);
+        }
+
+        if (isOpen) _openBurst = _burstQueue.end();
+        _queuedBytes -= burst.numElems*_deviceElemSize*burst.buffs.size();
+        _burstQueue.erase(it);
     }
+
+    return SOAPY_REMOTE_SOCKET_TIMEOUT_US;
 }
 
 void ServerStreamData::sendEndpointWork(void)
 {
     setThreadPrioWithLogging(priority);
-    assert(endpoint != nullptr);
-    assert(endpoint->getElemSize() != 0);
-    assert(endpoint->getNumChans() != 0);
 
-    //setup worker data structures
+    while (not done)
+    {
+        if (this->sendEndpointOnce(SOAPY_REMOTE_SOCKET_TIMEOUT_US) == STREAM_WORK_EXIT) return;
+    }
+}
+
+StreamWorkResult ServerStreamData::sendEndpointOnce(const long timeoutUs)
+{
     int ret = 0;
-    size_t handle = 0;
     int flags = 0;
     long long timeNs = 0;
-    const auto elemSize = endpoint->getElemSize();
-    std::vector<void *> buffs(endpoint->getNumChans());
-    const size_t mtuElems = device->getStreamMTU(stream);
+    const auto elemSize = _deviceElemSize;
+
+    if (_directAccess) return this->sendDirectOnce(timeoutUs);
 
-    //loop forever until signaled done
+    //one pass of the send work
     //1) waits on the endpoint to become ready
     //2) acquire the send buffer from the endpoint
     //3) read from the device stream into the endpoint buffer
     //4) release the buffer back to the endpoint (sends)
-    while (not done)
+    //The acquired buffer is held across passes until the device read completes.
+    if (not _sendAcquired)
     {
-        if (not endpoint->waitSend(SOAPY_REMOTE_SOCKET_TIMEOUT_US)) continue;
-        ret = endpoint->acquireSend(handle, buffs.data());
+        if (not endpoint->waitSend(timeoutUs)) return STREAM_WORK_WAIT;
+        ret = endpoint->acquireSend(_sendHandle, _sendBuffs.data());
         if (ret < 0)
         {
             SoapySDR::logf(SOAPY_SDR_ERROR, "Server-side send endpoint: %s; worker quitting...", streamSock->lastErrorMsg());
-            return;
+            return STREAM_WORK_EXIT;
         }
+        _sendElems = size_t(ret);
+        _sendAcquired = true;
+    }
+
+    //The latency budget starts before the first read and bounds its timeout,
+    //so the first sample in the datagram has not waited longer than the budget.
+    const auto flushTime = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(maxLatencyUs);
+    const long readTimeoutUs = (maxLatencyUs == 0)?timeoutUs:std::min(timeoutUs, maxLatencyUs);
 
-        //Read only up to MTU size with a timeout for minimal waiting.
-        //In the next section we will continue the read with non-blocking.
-        size_t elemsLeft = size_t(ret);
-        size_t elemsRead = 0;
-        while (not done)
+    //Read only up to MTU size with a timeout for minimal waiting.
+    //In the next section we will continue the read with non-blocking.
+    //With the server-side conversion, read into the device format buffers.
+    size_t elemsLeft = _sendElems;
+    size_t elemsRead = 0;
+    for (size_t i = 0; i < _convertStorage.size(); i++) _sendConvBuffs[i] = _convertStorage[i].data();
+    auto &buffs = (convertKernel == nullptr)?_sendBuffs:_sendConvBuffs;
+    ret = device->readStream(stream, buffs.data(), std::min(_mtuElems, elemsLeft), flags, timeNs, readTimeoutUs);
+    if (ret == SOAPY_SDR_TIMEOUT) return STREAM_WORK_IDLE;
+    _sendAcquired = false;
+    if (ret >= 0) //ret < 0 will be propagated to remote endpoint
+    {
+        elemsLeft -= ret;
+        elemsRead += ret;
+        incrementBuffs(buffs, ret, elemSize);
+    }
+
+    //fill remaining buffer with no timeout
+    //This is a latency optimization to forward to the host ASAP,
+    //but to use the full bandwidth when more data is available.
+    //With a latency budget, keep reading until the oldest sample
+    //in the buffer has waited for the budget, so slow streams
+    //still forward full datagrams when the data arrives in time.
+    //Do not allow this optimization when end of burst or single packet mode to preserve boundaries
+    static const int trailingFlags(SOAPY_SDR_END_BURST | SOAPY_SDR_ONE_PACKET | SOAPY_SDR_END_ABRUPT);
+    while (elemsRead != 0 and elemsLeft != 0 and (flags & trailingFlags) == 0)
+    {
+        const auto budgetUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            flushTime - std::chrono::high_resolution_clock::now()).count();
+        const long budgetTimeoutUs = long(std::max<long long>(budgetUs, 0));
+        int flags1 = 0;
+        long long timeNs1 = 0;
+        ret = device->readStream(stream, buffs.data(), elemsLeft, flags1, timeNs1, budgetTimeoutUs);
+        if (ret == SOAPY_SDR_TIMEOUT) ret = 0; //timeouts OK
+        if (ret > 0)
         {
-            flags = 0; //flags is an in/out parameter and must be cleared for consistency
-            const size_t numElems = std::min(mtuElems, elemsLeft);
-            ret = device->readStream(stream, buffs.data(), numElems, flags, timeNs, SOAPY_REMOTE_SOCKET_TIMEOUT_US);
-            if (ret == SOAPY_SDR_TIMEOUT) continue;
-            if (ret < 0)
-            {
-                //ret will be propagated to remote endpoint
-                break;
-            }
             elemsLeft -= ret;
             elemsRead += ret;
             incrementBuffs(buffs, ret, elemSize);
-            break;
         }
 
-        //fill remaining buffer with no timeout
-        //This is a latency optimization to forward to the host ASAP,
-        //but to use the full bandwidth when more data is available.
-        //Do not allow this optimization when end of burst or single packet mode to preserve boundaries
-        static const int trailingFlags(SOAPY_SDR_END_BURST | SOAPY_SDR_ONE_PACKET | SOAPY_SDR_END_ABRUPT);
-        if (elemsRead != 0 and elemsLeft != 0 and (flags & trailingFlags) == 0)
+        //include trailing flags that come from the subsequent reads
+        flags |= (flags1 & trailingFlags);
+
+        //stop on error or when the latency budget is spent
+        if (ret < 0 or budgetTimeoutUs == 0) break;
+    }
+
+    //convert from the device format into the wire format
+    if (convertKernel != nullptr and elemsRead != 0)
+    {
+        for (size_t i = 0; i < _sendBuffs.size(); i++)
         {
-            int flags1 = 0;
-            long long timeNs1 = 0;
-            ret = device->readStream(stream, buffs.data(), elemsLeft, flags1, timeNs1, 0);
-            if (ret == SOAPY_SDR_TIMEOUT) ret = 0; //timeouts OK
-            if (ret > 0)
-            {
-                elemsLeft -= ret;
-                elemsRead += ret;
-            }
-
-            //include trailing flags that come from the second read
-            flags |= (flags1 & trailingFlags);
+            convertKernel->recv(_convertStorage[i].data(), _sendBuffs[i], elemsRead, scaleFactor);
         }
+    }
+
+    //release the buffer with flags and time from the first read
+    //if any read call returned an error, forward the error instead
+    endpoint->releaseSend(_sendHandle, (ret < 0)?ret:elemsRead, flags, timeNs);
+    return STREAM_WORK_AGAIN;
+}
 
-        //release the buffer with flags and time from the first read
-        //if any read call returned an error, forward the error instead
-        endpoint->releaseSend(handle, (ret < 0)?ret:elemsRead, flags, timeNs);
+StreamWorkResult ServerStreamData::sendDirectOnce(const long timeoutUs)
+{
+    const auto elemSize = endpoint->getElemSize();
+
+    //one pass of the direct send work
+    //1) waits on the endpoint to become ready
+    //2) acquire the read buffer from the device, held across passes
+    //3) send the next piece straight from the read buffer
+    //4) release the read buffer back to the device once forwarded
+    if (not endpoint->waitSend(timeoutUs)) return STREAM_WORK_WAIT;
+    if (not _dmaAcquired)
+    {
+        _dmaFlags = 0;
+        _dmaTimeNs = 0;
+        const int ret = device->acquireReadBuffer(stream, _dmaHandle, (const void **)_dmaBuffs.data(), _dmaFlags, _dmaTimeNs, timeoutUs);
+        if (ret == SOAPY_SDR_TIMEOUT) return STREAM_WORK_IDLE;
+        if (ret < 0)
+        {
+            //ret will be propagated to remote endpoint
+            endpoint->sendBuffs(_dmaBuffs.data(), ret, _dmaFlags, _dmaTimeNs);
+            return STREAM_WORK_AGAIN;
+        }
+        _dmaElemsLeft = size_t(ret);
+        _dmaAcquired = true;
+    }
+
+    //The read buffer may span several datagrams:
+    //the time applies to the first piece, trailing flags to the last.
+    static const int trailingFlags(SOAPY_SDR_END_BURST | SOAPY_SDR_ONE_PACKET | SOAPY_SDR_END_ABRUPT);
+    const size_t numElems = std::min(_dmaElemsLeft, endpoint->getBuffSize());
+    _dmaElemsLeft -= numElems;
+    const int flags = (_dmaElemsLeft == 0)?_dmaFlags:(_dmaFlags & ~trailingFlags);
+    endpoint->sendBuffs(_dmaBuffs.data(), int(numElems), flags, _dmaTimeNs);
+    _dmaFlags &= ~(SOAPY_SDR_HAS_TIME);
+    incrementBuffs(_dmaBuffs, numElems, elemSize);
+
+    if (_dmaElemsLeft == 0)
+    {
+        device->releaseReadBuffer(stream, _dmaHandle);
+        _dmaAcquired = false;
     }
+    return STREAM_WORK_AGAIN;
 }
 
 void ServerStreamData::statEndpointWork(void)
+{
+    while (not done)
+    {
+        if (this->statEndpointOnce(SOAPY_REMOTE_SOCKET_TIMEOUT_US) == STREAM_WORK_EXIT) return;
+    }
+}
+
+StreamWorkResult ServerStreamData::statEndpointOnce(const long timeoutUs)
 {
     assert(endpoint != nullptr);
 
-    int ret = 0;
     size_t chanMask = 0;
     int flags = 0;
     long long timeNs = 0;
 
-    while (not done)
-    {
-        ret = device->readStreamStatus(stream, chanMask, flags, timeNs, SOAPY_REMOTE_SOCKET_TIMEOUT_US);
-        if (ret == SOAPY_SDR_TIMEOUT) continue;
-        endpoint->writeStatus(ret, chanMask, flags, timeNs);
+    const int ret = device->readStreamStatus(stream, chanMask, flags, timeNs, timeoutUs);
+    if (ret == SOAPY_SDR_TIMEOUT) return STREAM_WORK_IDLE;
+    endpoint->writeStatus(ret, chanMask, flags, timeNs);
 
-        //exit the thread if stream status is not supported
-        //but only after reporting this to the local endpoint
-        if (ret == SOAPY_SDR_NOT_SUPPORTED) return;
-    }
+    //exit the work if stream status is not supported
+    //but only after reporting this to the local endpoint
+    if (ret == SOAPY_SDR_NOT_SUPPORTED) return STREAM_WORK_EXIT;
+    return STREAM_WORK_AGAIN;
 }
@@ -4,11 +4,16 @@
 #pragma once
 #include "SoapyRPCSocket.hpp"
 #include "ThreadPrioHelper.hpp"
+#include <chrono>
 #include <csignal> //sig_atomic_t
 #include <string>
 #include <thread>
+#include <vector>
+#include <map>
 
 class SoapyStreamEndpoint;
+class ServerStreamReactor;
+struct ConvertKernel;
 
 namespace SoapySDR
 {
@@ -16,10 +21,20 @@ namespace SoapySDR
     class Stream;
 }
 
+//! Result of a single pass over the stream work
+enum StreamWorkResult
+{
+    STREAM_WORK_AGAIN, //call again to continue the work
+    STREAM_WORK_IDLE, //no work was ready, call again later
+    STREAM_WORK_WAIT, //wait for the stream socket to become readable
+    STREAM_WORK_EXIT, //the work is finished, do not call again
+};
+
 /*!
  * Server-side stream data for client handler.
  * This class manages a recv/send endpoint,
- * and a thread to handle that endpoint.
+ * and a thread to handle that endpoint,
+ * or the shared reactor when one is provided.
  */
 class ServerStreamData
 {
@@ -45,6 +60,25 @@ public:
     //remote side of the stream endpoint
     SoapyStreamEndpoint *endpoint;
 
+    //shared reactor for the work or null for dedicated threads
+    ServerStreamReactor *reactor;
+
+    //receive latency budget before flushing a partial datagram
+    long maxLatencyUs;
+
+    //transmit burst scheduler configuration
+    bool scheduleBursts;
+    long scheduleLeadUs;
+
+    //when the next scheduled burst is due, set by each receive pass,
+    //the caller retries an idle pass or a pass waiting on the socket by then
+    std::chrono::steady_clock::time_point scheduleDueTime;
+
+    //server-side conversion with the wire format as the local format
+    //and the device format as the remote format, null when not converting
+    const ConvertKernel *convertKernel;
+    double scaleFactor;
+
     //hooks to start/stop work
     void startSendThread(void);
     void startRecvThread(void);
@@ -56,7 +90,59 @@ public:
     void sendEndpointWork(void);
     void statEndpointWork(void);
 
+    //single pass implementations for the worker and reactor
+    StreamWorkResult recvEndpointOnce(const long timeoutUs);
+    StreamWorkResult sendEndpointOnce(const long timeoutUs);
+    StreamWorkResult statEndpointOnce(const long timeoutUs);
+
 private:
+    //reset the work state before the first pass
+    void resetWorkState(void);
+    std::vector<const void *> _recvBuffs;
+    std::vector<void *> _sendBuffs;
+    size_t _sendHandle;
+    size_t _sendElems;
+    bool _sendAcquired; //send buffer held between passes
+    size_t _mtuElems;
+    size_t _deviceElemSize;
+
+    //device format buffers for the server-side conversion
+    std::vector<std::vector<char>> _convertStorage;
+    std::vector<const void *> _recvConvBuffs;
+    std::vector<void *> _sendConvBuffs;
+
+    //zero-copy forwarding with the device's direct buffer access
+    StreamWorkResult recvDirectOnce(const long timeoutUs);
+    StreamWorkResult sendDirectOnce(const long timeoutUs);
+    bool _directAccess;
+    std::vector<void *> _dmaBuffs;
+    size_t _dmaHandle;
+    bool _dmaAcquired; //read buffer held until forwarded
+    size_t _dmaElemsLeft;
+    int _dmaFlags;
+    long long _dmaTimeNs;
+
+    //write a buffer to the device stream, report errors to the endpoint
+    void writeDeviceBuffs(std::vector<const void *> &buffs, const size_t numElems, int flags, const long long timeNs);
+
+    //timed burst held by the scheduler until it is due
+    struct ScheduledBurst
+    {
+        int flags;
+        long long timeNs;
+        size_t numElems;
+        std::vector<std::vector<char>> buffs;
+    };
+
+    //scheduler implementation for the recv endpoint worker
+    void scheduleRecvBuffs(const std::vector<const void *> &buffs, const size_t numElems, const int flags, const long long timeNs);
+    void appendBurst(ScheduledBurst &burst, const std::vector<const void *> &buffs, const size_t numElems);
+    long dispatchDueBursts(void);
+    std::multimap<long long, ScheduledBurst> _burstQueue;
+    std::multimap<long long, ScheduledBurst>::iterator _openBurst;
+    bool _dropOpenBurst; //continuation of a late burst is discarded
+    size_t _queuedBytes;
+
     //worker thread for this stream
     std::thread *streamThread;
     std::thread *statusThread;
@@ -0,0 +1,352 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ServerStreamReactor.hpp"
+#include "ServerStreamData.hpp"
+#include "ThreadPrioHelper.hpp"
+#include "SoapyRemoteDefs.hpp"
+#include "SoapyURLUtils.hpp"
+#include <SoapySDR/Logger.hpp>
+#include <algorithm> //find, remove, min, max
+#include <cerrno>
+
+//Device calls made by the workers use this short timeout,
+//so that an idle stream only holds a worker for a brief pass.
+#define REACTOR_PASS_TIMEOUT_US (1*1000) //1 ms
+
+//Limit the datagrams forwarded in one pass over a busy stream,
+//so that the other streams of the pool get their turn.
+#define REACTOR_MAX_PASS_DATAGRAMS 64
+
+//An idle stream is parked before it is polled again,
+//the wait doubles from the pass timeout up to this limit.
+#define REACTOR_MAX_IDLE_US (4*1000) //4 ms
+
+ServerStreamReactor::ServerStreamReactor(const size_t numWorkers):
+    _done(false),
+    _ioThread(nullptr),
+    _statusThread(nullptr)
+{
+    //the wake socket is connected to itself on the loopback interface
+    if (_wakeSock.bind("udp://127.0.0.1:0") != 0)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "ServerStreamReactor wake socket bind FAIL: %s", _wakeSock.lastErrorMsg());
+    }
+    SoapyURL wakeURL(_wakeSock.getsockname());
+    wakeURL.setScheme("udp");
+    if (_wakeSock.connect(wakeURL.toString()) != 0)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "ServerStreamReactor wake socket connect FAIL: %s", _wakeSock.lastErrorMsg());
+    }
+    _wakeSock.setNonBlocking(true);
+
+    //the workers are split between the pools, at least one each
+    const size_t numIoWorkers = std::max<size_t>((numWorkers+1)/2, 1);
+    const size_t numDeviceWorkers = std::max<size_t>(numWorkers/2, 1);
+
+    _ioThread = new std::thread(&ServerStreamReactor::ioLoop, this);
+    _statusThread = new std::thread(&ServerStreamReactor::statusLoop, this);
+    for (size_t i = 0; i < numIoWorkers; i++)
+    {
+        _workerThreads.push_back(new std::thread(&ServerStreamReactor::workerLoop, this, &_ioQueue));
+    }
+    for (size_t i = 0; i < numDeviceWorkers; i++)
+    {
+        _workerThreads.push_back(new std::thread(&ServerStreamReactor::workerLoop, this, &_deviceQueue));
+    }
+}
+
+ServerStreamReactor::~ServerStreamReactor(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _ioQueue.cond.notify_all();
+    _deviceQueue.cond.notify_all();
+    _statusCond.notify_all();
+    this->wakeup();
+
+    for (auto thread : _workerThreads)
+    {
+        thread->join();
+        delete thread;
+    }
+    _statusThread->join();
+    delete _statusThread;
+    _ioThread->join();
+    delete _ioThread;
+}
+
+/***********************************************************************
+ * Stream registration
+ **********************************************************************/
+void ServerStreamReactor::add(ServerStreamData *data, const bool isRecv)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    //all work starts in the queue, the first pass over
+    //the stream finds out if it waits on the stream socket
+    Task streamTask;
+    streamTask.data = data;
+    streamTask.kind = isRecv?TASK_RECV:TASK_SEND;
+    streamTask.state = TASK_QUEUED;
+    streamTask.removing = false;
+    streamTask.wakeTime = std::chrono::steady_clock::time_point::max();
+    streamTask.idleUs = 0;
+    _tasks.push_back(streamTask);
+    this->enqueue(&_tasks.back());
+
+    //the status task is picked up by the status thread
+    Task statusTask;
+    statusTask.data = data;
+    statusTask.kind = TASK_STATUS;
+    statusTask.state = TASK_QUEUED;
+    statusTask.removing = false;
+    statusTask.wakeTime = std::chrono::steady_clock::time_point::max();
+    statusTask.idleUs = 0;
+    _tasks.push_back(statusTask);
+    _statusCond.notify_one();
+}
+
+void ServerStreamReactor::remove(ServerStreamData *data)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    //the tasks of the stream are no longer requeued,
+    //so a busy stream cannot keep the removal waiting
+    for (auto &task : _tasks)
+    {
+        if (task.data == data) task.removing = true;
+    }
+
+    while (true)
+    {
+        bool busy = false;
+        auto it = _tasks.begin();
+        while (it != _tasks.end())
+        {
+            Task *task = &(*it);
+            if (task->data != data)
+            {
+                ++it;
+                continue;
+            }
+
+            //wait for a pass in progress or the I/O thread to let go of the task
+            const bool selecting = std::find(_selectTasks.begin(), _selectTasks.end(), task) != _selectTasks.end();
+            if (task->state == TASK_RUNNING or selecting)
+            {
+                busy = true;
+                ++it;
+                continue;
+            }
+
+            if (task->state == TASK_QUEUED and task->kind != TASK_STATUS)
+            {
+                auto &queue = this->workQueue(task).tasks;
+                queue.erase(std::remove(queue.begin(), queue.end(), task), queue.end());
+            }
+            _tasks.erase(it++);
+        }
+
+        if (not busy) return;
+        this->wakeup();
+        _idleCond.wait(lock);
+    }
+}
+
+/***********************************************************************
+ * I/O thread: wait on the sockets of streams waiting for network data,
+ * and requeue the waiting and parked streams when their wake time is up
+ **********************************************************************/
+void ServerStreamReactor::ioLoop(void)
+{
+    std::vector<SoapyRPCSocket *> socks;
+    std::vector<bool> ready;
+    char wakeBuff[64];
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _done)
+    {
+        //the wake socket is always the first socket in the list,
+        //and the select returns by the earliest wake time
+        socks.clear();
+        socks.push_back(&_wakeSock);
+        auto wakeTime = std::chrono::steady_clock::now() + std::chrono::microseconds(SOAPY_REMOTE_SOCKET_TIMEOUT_US);
+        for (auto &task : _tasks)
+        {
+            if (task.removing) continue;
+            if (task.state == TASK_WAITING or task.state == TASK_PARKED) wakeTime = std::min(wakeTime, task.wakeTime);
+            if (task.state != TASK_WAITING) continue;
+            _selectTasks.push_back(&task);
+            socks.push_back(task.data->streamSock);
+        }
+        ready.resize(socks.size());
+        lock.unlock();
+
+        const auto timeoutUs = std::chrono::duration_cast<std::chrono::microseconds>(wakeTime - std::chrono::steady_clock::now()).count();
+        const int socksReady = SoapyRPCSocket::selectRecvMultiple(socks, ready, long(std::max<long long>(timeoutUs, 0)));
+        if (socksReady < 0 and errno != EINTR) //continue after interrupted system call
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "ServerStreamReactor::selectRecvMultiple() = %d", socksReady);
+        }
+        if (socksReady > 0 and ready[0])
+        {
+            while (_wakeSock.selectRecv(0)) _wakeSock.recv(wakeBuff, sizeof(wakeBuff));
+        }
+
+        //move the ready streams into the work queue
+        lock.lock();
+        for (size_t i = 0; socksReady > 0 and i < _selectTasks.size(); i++)
+        {
+            if (not ready[i+1] or _selectTasks[i]->removing) continue;
+            this->enqueue(_selectTasks[i]);
+        }
+        _selectTasks.clear();
+
+        //and the streams that reached their wake time
+        const auto now = std::chrono::steady_clock::now();
+        for (auto &task : _tasks)
+        {
+            if (task.removing or task.wakeTime > now) continue;
+            if (task.state == TASK_WAITING or task.state == TASK_PARKED) this->enqueue(&task);
+        }
+        _idleCond.notify_all();
+    }
+}
+
+void ServerStreamReactor::wakeup(void)
+{
+    const char wake(0);
+    _wakeSock.send(&wake, sizeof(wake));
+}
+
+/***********************************************************************
+ * Worker threads: make a pass over a stream's work
+ **********************************************************************/
+ServerStreamReactor::WorkQueue &ServerStreamReactor::workQueue(const Task *task)
+{
+    //the receive streams of the device read in the device pool
+    return (task->kind == TASK_SEND)?_deviceQueue:_ioQueue;
+}
+
+void ServerStreamReactor::enqueue(Task *task)
+{
+    auto &queue = this->workQueue(task);
+    task->state = TASK_QUEUED;
+    queue.tasks.push_back(task);
+    queue.cond.notify_one();
+}
+
+void ServerStreamReactor::park(Task *task, const TaskState state, const std::chrono::steady_clock::time_point &wakeTime)
+{
+    //the I/O thread picks up the new wake time
+    task->state = state;
+    task->wakeTime = wakeTime;
+    this->wakeup();
+}
+
+StreamWorkResult ServerStreamReactor::runTask(Task *task)
+{
+    //only the first call may block on the device,
+    //the following calls forward the data that is already ready
+    StreamWorkResult result(STREAM_WORK_EXIT);
+    auto data = task->data;
+    size_t i = 0;
+    for (; i < REACTOR_MAX_PASS_DATAGRAMS; i++)
+    {
+        const long timeoutUs = (i == 0)?REACTOR_PASS_TIMEOUT_US:0;
+        switch (task->kind)
+        {
+        //receive work runs once network data is ready or a scheduled burst is due
+        case TASK_RECV: result = data->recvEndpointOnce(timeoutUs); break;
+        case TASK_SEND: result = data->sendEndpointOnce(timeoutUs); break;
+        case TASK_STATUS: result = data->statEndpointOnce(timeoutUs); break;
+        }
+        if (result != STREAM_WORK_AGAIN) break;
+    }
+
+    //a stream that forwarded data in this pass is not idle
+    if (result == STREAM_WORK_IDLE and i != 0) return STREAM_WORK_AGAIN;
+    return result;
+}
+
+void ServerStreamReactor::workerLoop(WorkQueue *queue)
+{
+    const auto errorMsg = setThreadPrio(SOAPY_REMOTE_DEFAULT_THREAD_PRIORITY);
+    if (not errorMsg.empty()) SoapySDR::logf(SOAPY_SDR_WARNING,
+        "Set thread priority %g failed: %s", SOAPY_REMOTE_DEFAULT_THREAD_PRIORITY, errorMsg.c_str());
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _done)
+    {
+        if (queue->tasks.empty())
+        {
+            queue->cond.wait(lock);
+            continue;
+        }
+
+        Task *task = queue->tasks.front();
+        queue->tasks.pop_front();
+        task->state = TASK_RUNNING;
+        lock.unlock();
+
+        const auto result = this->runTask(task);
+
+        lock.lock();
+        //the scheduler wakes the receive stream when its next burst is due
+        const bool scheduled = task->kind == TASK_RECV and task->data->scheduleBursts;
+        const auto now = std::chrono::steady_clock::now();
+        if (task->removing) task->state = TASK_FINISHED;
+        else switch (result)
+        {
+        case STREAM_WORK_AGAIN:
+            task->idleUs = 0;
+            this->enqueue(task);
+            break;
+
+        //a device without ready data has no event to wait on,
+        //it is parked and polled again after a growing wait
+        case STREAM_WORK_IDLE:
+            task->idleUs = std::min<long>(std::max<long>(task->idleUs*2, REACTOR_PASS_TIMEOUT_US), REACTOR_MAX_IDLE_US);
+            this->park(task, TASK_PARKED, scheduled?task->data->scheduleDueTime:now+std::chrono::microseconds(task->idleUs));
+            break;
+        case STREAM_WORK_WAIT:
+            task->idleUs = 0;
+            this->park(task, TASK_WAITING, scheduled?task->data->scheduleDueTime:std::chrono::steady_clock::time_point::max());
+            break;
+        case STREAM_WORK_EXIT:
+            task->state = TASK_FINISHED;
+            break;
+        }
+        _idleCond.notify_all();
+    }
+}
+
+/***********************************************************************
+ * Status thread: poll the stream status of every stream in turn
+ **********************************************************************/
+void ServerStreamReactor::statusLoop(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _done)
+    {
+        bool hasStatus = false;
+        for (auto &task : _tasks)
+        {
+            if (_done) break;
+            if (task.kind != TASK_STATUS or task.state != TASK_QUEUED) continue;
+            hasStatus = true;
+            task.state = TASK_RUNNING;
+            lock.unlock();
+
+            const auto result = this->runTask(&task);
+
+            lock.lock();
+            task.state = (result == STREAM_WORK_EXIT or task.removing)?TASK_FINISHED:TASK_QUEUED;
+            _idleCond.notify_all();
+        }
+        if (not hasStatus) _statusCond.wait(lock);
+    }
+}
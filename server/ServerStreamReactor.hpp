@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "SoapyRPCSocket.hpp"
+#include "ServerStreamData.hpp" //StreamWorkResult
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <deque>
+#include <list>
+
+/*!
+ * A shared reactor to run the work of all server streams.
+ * An I/O thread waits on the stream sockets of every stream.
+ * A pool of I/O workers handles the streams with network data ready,
+ * and a separate pool of device workers performs the blocking reads
+ * of the device for the receive streams, so an idle device does not
+ * hold up the network work. A single thread polls the stream status.
+ * A pass forwards all the data that is ready before the stream is
+ * requeued, so the thread count does not grow with the number of streams.
+ * A stream without ready data is parked by the I/O thread until a timer,
+ * so idle streams are polled at a growing interval and not continuously.
+ */
+class ServerStreamReactor
+{
+public:
+    //! Create the reactor with the given number of worker threads, split between the pools
+    ServerStreamReactor(const size_t numWorkers);
+
+    ~ServerStreamReactor(void);
+
+    //! Start running the stream and status work of a stream
+    void add(ServerStreamData *data, const bool isRecv);
+
+    //! Stop running the work of a stream, wait for any pass in progress
+    void remove(ServerStreamData *data);
+
+private:
+    enum TaskState
+    {
+        TASK_QUEUED,  //waiting for a worker
+        TASK_WAITING, //waiting for the stream socket or the wake time
+        TASK_PARKED,  //waiting for the wake time
+        TASK_RUNNING, //a worker is making a pass
+        TASK_FINISHED,
+    };
+
+    enum TaskKind
+    {
+        TASK_RECV,
+        TASK_SEND,
+        TASK_STATUS,
+    };
+
+    struct Task
+    {
+        ServerStreamData *data;
+        TaskKind kind;
+        TaskState state;
+        bool removing; //do not requeue after the pass in progress
+        std::chrono::steady_clock::time_point wakeTime; //requeue a waiting or parked task by then
+        long idleUs; //grows with each idle pass in a row
+    };
+
+    //the worker pool that runs a task, device reads have their own pool
+    struct WorkQueue
+    {
+        std::deque<Task *> tasks;
+        std::condition_variable cond; //signals work in the queue
+    };
+
+    WorkQueue &workQueue(const Task *task);
+    void enqueue(Task *task);
+    void park(Task *task, const TaskState state, const std::chrono::steady_clock::time_point &wakeTime);
+    StreamWorkResult runTask(Task *task);
+
+    void ioLoop(void);
+    void workerLoop(WorkQueue *queue);
+    void statusLoop(void);
+    void wakeup(void);
+
+    bool _done;
+    std::mutex _mutex;
+    std::condition_variable _idleCond; //signals a task changed hands
+    std::condition_variable _statusCond; //signals a status task was added
+    std::list<Task> _tasks;
+    WorkQueue _ioQueue;
+    WorkQueue _deviceQueue;
+    std::vector<Task *> _selectTasks; //tasks in the current select call
+
+    //loopback datagram socket to interrupt the I/O thread
+    SoapyRPCSocket _wakeSock;
+
+    std::thread *_ioThread;
+    std::thread *_statusThread;
+    std::vector<std::thread *> _workerThreads;
+};
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include "SoapyServer.hpp"
+#include "ServerStreamReactor.hpp"
 #include "SoapyRemoteDefs.hpp"
 #include "SoapyURLUtils.hpp"
 #include "SoapyInfoUtils.hpp"
@@ -13,6 +14,9 @@
 #include <iostream>
 #include <getopt.h>
 #include <csignal>
+#include <string>
+#include <thread>
+#include <algorithm> //max
 
 /***********************************************************************
  * Print help message
@@ -23,6 +27,7 @@ static int printHelp(void)
     std::cout << "  Options summary:" << std::endl;
     std::cout << "    --help \t\t\t\t Print this help message" << std::endl;
     std::cout << "    --bind \t\t\t\t Bind and serve forever" << std::endl;
+    std::cout << "    --threads \t\t\t\t Shared stream worker threads (default per-stream)" << std::endl;
     std::cout << std::endl;
     return EXIT_SUCCESS;
 }
@@ -40,7 +45,7 @@ void sigIntHandler(const int)
 /***********************************************************************
  * Launch the server
  **********************************************************************/
-static int runServer(void)
+static int runServer(const std::string &bindArg, const size_t numStreamThreads)
 {
     SoapySocketSession sess;
     const bool isIPv6Supported = not SoapyRPCSocket(SoapyURL("tcp", "::", "0").toString()).null();
@@ -48,8 +53,7 @@ static int runServer(void)
     const int ipVerServices = isIPv6Supported?SOAPY_REMOTE_IPVER_UNSPEC:SOAPY_REMOTE_IPVER_INET;
 
     //extract url from user input or generate automatically
-    const bool optargHasURL = (optarg != NULL and not std::string(optarg).empty());
-    auto url = (optargHasURL)? SoapyURL(optarg) : SoapyURL("tcp", defaultBindNode, "");
+    auto url = (not bindArg.empty())? SoapyURL(bindArg) : SoapyURL("tcp", defaultBindNode, "");
 
     //default url parameters when not specified
     if (url.getScheme().empty()) url.setScheme("tcp");
@@ -69,7 +73,15 @@ static int runServer(void)
     }
     std::cout << "Server bound to " << s.getsockname() << std::endl;
     s.listen(SOAPY_REMOTE_LISTEN_BACKLOG);
-    auto serverListener = new SoapyServerListener(s, serverUUID);
+
+    //the shared reactor runs all streams on a fixed number of threads
+    ServerStreamReactor *streamReactor(nullptr);
+    if (numStreamThreads != 0)
+    {
+        std::cout << "Launching stream reactor with " << numStreamThreads << " network and device worker threads..." << std::endl;
+        streamReactor = new ServerStreamReactor(numStreamThreads);
+    }
+    auto serverListener = new SoapyServerListener(s, serverUUID, streamReactor);
 
     std::cout << "Launching discovery server... " << std::endl;
     auto ssdpEndpoint = new SoapySSDPEndpoint();
@@ -104,6 +116,7 @@ static int runServer(void)
 
     std::cout << "Shutdown client handler threads" << std::endl;
     delete serverListener;
+    delete streamReactor;
     s.close();
 
     std::cout << "Cleanup complete, exiting" << std::endl;
@@ -126,18 +139,32 @@ int main(int argc, char *argv[])
     static struct option long_options[] = {
         {"help", no_argument, 0, 'h'},
         {"bind", optional_argument, 0, 'b'},
+        {"threads", optional_argument, 0, 't'},
         {0, 0, 0,  0}
     };
     int long_index = 0;
     int option = 0;
+    bool bind = false;
+    std::string bindArg;
+    size_t numStreamThreads = 0;
     while ((option = getopt_long_only(argc, argv, "", long_options, &long_index)) != -1)
     {
         switch (option)
         {
         case 'h': return printHelp();
-        case 'b': return runServer();
+        case 'b':
+            bind = true;
+            if (optarg != NULL) bindArg = optarg;
+            break;
+        case 't':
+            //the workers of both pools total one per core when the count is not specified
+            numStreamThreads = std::max(std::thread::hardware_concurrency(), 1u);
+            if (optarg != NULL) numStreamThreads = std::strtoul(optarg, NULL, 10);
+            break;
+        default: return printHelp();
         }
     }
+    if (bind) return runServer(bindArg, numStreamThreads);
 
     //unknown or unspecified options, do help...
     return printHelp();
@@ -8,6 +8,7 @@
 #include <map>
 
 class SoapyRPCSocket;
+class ServerStreamReactor;
 
 //! Client handler data
 struct SoapyServerThreadData
@@ -19,6 +20,7 @@ struct SoapyServerThreadData
     std::thread *thread;
     SoapyRPCSocket *client;
     std::string uuid;
+    ServerStreamReactor *reactor;
 };
 
 /*!
@@ -27,7 +29,7 @@ struct SoapyServerThreadData
 class SoapyServerListener
 {
 public:
-    SoapyServerListener(SoapyRPCSocket &sock, const std::string &uuid);
+    SoapyServerListener(SoapyRPCSocket &sock, const std::string &uuid, ServerStreamReactor *reactor);
 
     ~SoapyServerListener(void);
 
@@ -36,6 +38,7 @@ public:
 private:
     SoapyRPCSocket &_sock;
     const std::string _uuid;
+    ServerStreamReactor *_reactor;
     size_t _handlerId;
     std::map<size_t, SoapyServerThreadData> _handlers;
 };
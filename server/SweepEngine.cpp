@@ -0,0 +1,213 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SweepEngine.hpp"
+#include "SoapyRemoteDefs.hpp"
+#include "SoapyRPCSocket.hpp"
+#include "SoapyRPCPacker.hpp"
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <stdexcept>
+#include <sstream>
+#include <cmath>
+#include <algorithm> //min
+
+//timeout for a stream read before rechecking status
+#define SWEEP_READ_TIMEOUT_US 100000
+
+static const double PI = 3.14159265358979323846;
+
+static std::string planArg(const SoapySDR::Kwargs &plan, const std::string &key, const std::string &def)
+{
+    const auto it = plan.find(key);
+    return (it == plan.end())?def:it->second;
+}
+
+//in-place radix-2 decimation in time
+static void fft(std::vector<std::complex<double>> &x)
+{
+    const size_t n = x.size();
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; (j & bit) != 0; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(x[i], x[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        const std::complex<double> wlen = std::polar(1.0, -2*PI/len);
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> w(1.0);
+            for (size_t k = 0; k < len/2; k++)
+            {
+                const auto u = x[i+k];
+                const auto v = x[i+k+len/2]*w;
+                x[i+k] = u+v;
+                x[i+k+len/2] = u-v;
+                w *= wlen;
+            }
+        }
+    }
+}
+
+static double powerToDb(const double power)
+{
+    return 10*std::log10(std::max(power, 1e-20));
+}
+
+SoapySweepEngine::SoapySweepEngine(SoapyRPCSocket &sock, SoapySDR::Device *device, const SoapySDR::Kwargs &plan):
+    _sock(sock),
+    _device(device),
+    _stream(nullptr),
+    _channel(std::stoul(planArg(plan, "channel", "0"))),
+    _settleSamples(0),
+    _captureSamples(std::stoul(planArg(plan, "samples", "4096"))),
+    _fftSize(std::stoul(planArg(plan, "fft", "0"))),
+    _repeat(planArg(plan, "repeat", "false") == "true"),
+    _done(false)
+{
+    if (_device == nullptr) throw std::runtime_error("SoapySweepEngine() no device");
+
+    //the frequency plan as a list or a range
+    const auto freqs = planArg(plan, "freqs", "");
+    if (not freqs.empty())
+    {
+        std::stringstream ss(freqs);
+        std::string freq;
+        while (ss >> freq) _freqs.push_back(std::stod(freq));
+    }
+    else
+    {
+        const double start = std::stod(planArg(plan, "start", "0"));
+        const double stop = std::stod(planArg(plan, "stop", "0"));
+        const double step = std::stod(planArg(plan, "step", "0"));
+        if (step <= 0.0 or stop < start) throw std::runtime_error("SoapySweepEngine() bad start, stop, step");
+        for (size_t i = 0; start + i*step <= stop*(1+1e-12); i++) _freqs.push_back(start + i*step);
+    }
+    if (_freqs.empty()) throw std::runtime_error("SoapySweepEngine() empty frequency plan");
+    if (_captureSamples == 0) throw std::runtime_error("SoapySweepEngine() no samples to capture");
+    if (_fftSize != 0 and ((_fftSize & (_fftSize-1)) != 0 or _fftSize > _captureSamples))
+    {
+        throw std::runtime_error("SoapySweepEngine() fft size must be a power of two up to the samples");
+    }
+
+    const double rate = _device->getSampleRate(SOAPY_SDR_RX, _channel);
+    _settleSamples = size_t(std::stod(planArg(plan, "settle_us", "1000"))*rate/1e6);
+
+    _stream = _device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32, std::vector<size_t>(1, _channel));
+}
+
+SoapySweepEngine::~SoapySweepEngine(void)
+{
+    _done = true;
+    if (_thread.joinable()) _thread.join();
+    _device->closeStream(_stream);
+}
+
+void SoapySweepEngine::start(void)
+{
+    if (_thread.joinable()) return;
+    _thread = std::thread(&SoapySweepEngine::sweepLoop, this);
+}
+
+bool SoapySweepEngine::readSamples(std::complex<float> *buff, const size_t numSamples)
+{
+    size_t numRead = 0;
+    while (numRead < numSamples)
+    {
+        if (_done) return false;
+        void *buffs[] = {buff+numRead};
+        int flags = 0;
+        long long timeNs = 0;
+        const int ret = _device->readStream(_stream, buffs, numSamples-numRead, flags, timeNs, SWEEP_READ_TIMEOUT_US);
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_OVERFLOW) numRead = 0; //the capture must be contiguous
+        else if (ret < 0) throw std::runtime_error("SoapySweepEngine::readStream() error "+std::to_string(ret));
+        else numRead += size_t(ret);
+    }
+    return true;
+}
+
+bool SoapySweepEngine::dropSamples(std::vector<std::complex<float>> &buff, const size_t numSamples)
+{
+    //long settle times are read through the capture buffer in chunks
+    for (size_t numDropped = 0; numDropped < numSamples; numDropped += buff.size())
+    {
+        if (not this->readSamples(buff.data(), std::min(buff.size(), numSamples-numDropped))) return false;
+    }
+    return true;
+}
+
+std::vector<double> SoapySweepEngine::powerSpectrum(const std::vector<std::complex<float>> &samples) const
+{
+    //the mean power without an FFT size
+    if (_fftSize == 0)
+    {
+        double power = 0.0;
+        for (const auto &s : samples) power += std::norm(s);
+        return std::vector<double>(1, powerToDb(power/samples.size()));
+    }
+
+    //Hann window normalized so that a full scale tone is 0 dB
+    std::vector<double> window(_fftSize);
+    double windowSum = 0.0;
+    for (size_t i = 0; i < _fftSize; i++)
+    {
+        window[i] = 0.5 - 0.5*std::cos(2*PI*i/_fftSize);
+        windowSum += window[i];
+    }
+
+    //average the frames of the capture
+    const size_t numFrames = samples.size()/_fftSize;
+    std::vector<double> power(_fftSize, 0.0);
+    std::vector<std::complex<double>> frame(_fftSize);
+    for (size_t f = 0; f < numFrames; f++)
+    {
+        for (size_t i = 0; i < _fftSize; i++) frame[i] = std::complex<double>(samples[f*_fftSize+i])*window[i];
+        fft(frame);
+        for (size_t i = 0; i < _fftSize; i++) power[i] += std::norm(frame[i]);
+    }
+
+    //shift the center frequency into the middle bin
+    std::vector<double> result(_fftSize);
+    const double scale = 1.0/(numFrames*windowSum*windowSum);
+    for (size_t i = 0; i < _fftSize; i++) result[i] = powerToDb(power[(i+_fftSize/2)%_fftSize]*scale);
+    return result;
+}
+
+void SoapySweepEngine::sweepLoop(void)
+{
+    std::vector<std::complex<float>> samples(_captureSamples);
+    try
+    {
+        int ret = _device->activateStream(_stream);
+        if (ret != 0) throw std::runtime_error("SoapySweepEngine::activateStream() error "+std::to_string(ret));
+
+        //the reads only fail to complete when stopped
+        do
+        {
+            for (const double freq : _freqs)
+            {
+                _device->setFrequency(SOAPY_SDR_RX, _channel, freq);
+                if (not this->dropSamples(samples, _settleSamples)) break;
+                if (not this->readSamples(samples.data(), samples.size())) break;
+
+                SoapyRPCPacker packer(_sock);
+                packer & freq;
+                packer & this->powerSpectrum(samples);
+                packer();
+            }
+        }
+        while (_repeat and not _done);
+
+        _device->deactivateStream(_stream);
+    }
+    catch (const std::exception &ex)
+    {
+        //the client or the device went away, stop sweeping
+        SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySweepEngine::sweepLoop() FAIL: %s", ex.what());
+    }
+}
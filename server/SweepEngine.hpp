@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Types.hpp>
+#include <csignal> //sig_atomic_t
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <complex>
+
+class SoapyRPCSocket;
+
+namespace SoapySDR
+{
+    class Device;
+    class Stream;
+}
+
+/*!
+ * The sweep engine runs a frequency plan on a receive channel in a thread.
+ * Every step tunes the channel, drops the samples of the settle time,
+ * and captures a block of samples from a stream that stays active.
+ * Only the result of a step is pushed over the socket:
+ * the frequency and the mean power in dB, or with an FFT size,
+ * the averaged power spectrum in dB with the center bin in the middle.
+ */
+class SoapySweepEngine
+{
+public:
+    SoapySweepEngine(SoapyRPCSocket &sock, SoapySDR::Device *device, const SoapySDR::Kwargs &plan);
+
+    ~SoapySweepEngine(void);
+
+    //! Start sweeping, call after the reply to the start was sent
+    void start(void);
+
+private:
+    void sweepLoop(void);
+
+    //read exactly the number of samples, false when stopped
+    bool readSamples(std::complex<float> *buff, const size_t numSamples);
+
+    //read and drop the samples through the buffer, false when stopped
+    bool dropSamples(std::vector<std::complex<float>> &buff, const size_t numSamples);
+
+    std::vector<double> powerSpectrum(const std::vector<std::complex<float>> &samples) const;
+
+    SoapyRPCSocket &_sock;
+    SoapySDR::Device *_device;
+    SoapySDR::Stream *_stream;
+    size_t _channel;
+    std::vector<double> _freqs;
+    size_t _settleSamples;
+    size_t _captureSamples;
+    size_t _fftSize;
+    bool _repeat;
+    std::thread _thread;
+    sig_atomic_t _done;
+};
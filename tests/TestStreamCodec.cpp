@@ -0,0 +1,263 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SoapyStreamCodec.hpp"
+#include <SoapySDR/Formats.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+//odd counts and counts around the 64 component blocks
+static const size_t ELEM_COUNTS[] = {1, 3, 31, 32, 33, 63, 65, 127, 1023};
+
+enum SignalKind
+{
+    SIGNAL_ZERO,
+    SIGNAL_TONE, //a small sine wave
+    SIGNAL_RANDOM, //random full scale components
+    SIGNAL_EXTREME, //alternating component limits, the widest deltas
+};
+
+static const char *signalName(const SignalKind kind)
+{
+    switch (kind)
+    {
+    case SIGNAL_ZERO: return "zero";
+    case SIGNAL_TONE: return "tone";
+    case SIGNAL_RANDOM: return "random";
+    case SIGNAL_EXTREME: return "extreme";
+    }
+    return "";
+}
+
+//fill the components of a CS16, CS8 or CU8 buffer
+static std::vector<uint8_t> makeSignal(const SignalKind kind, const size_t numElems, const size_t compSize)
+{
+    std::vector<uint8_t> buff(numElems*2*compSize);
+    for (size_t i = 0; i < numElems*2; i++)
+    {
+        long value = 0;
+        if (kind == SIGNAL_TONE) value = std::lround(20*std::sin(i*0.05));
+        if (kind == SIGNAL_RANDOM) value = rand();
+        if (kind == SIGNAL_EXTREME) value = (i%3 == 0)?-32768:32767;
+        if (compSize == 2)
+        {
+            const int16_t comp = int16_t(value);
+            std::memcpy(buff.data()+i*2, &comp, sizeof(comp));
+        }
+        else buff[i] = uint8_t(value >> ((kind == SIGNAL_EXTREME)?8:0));
+    }
+    return buff;
+}
+
+/***********************************************************************
+ * Lossless codec: every signal decodes to the exact input,
+ * and truncated or malformed inputs are rejected.
+ **********************************************************************/
+static int testLossless(const std::string &format, const size_t compSize)
+{
+    int failures = 0;
+    SoapyStreamCodec codec("lossless", format);
+
+    for (const auto kind : {SIGNAL_ZERO, SIGNAL_TONE, SIGNAL_RANDOM, SIGNAL_EXTREME})
+    {
+        for (const size_t numElems : ELEM_COUNTS)
+        {
+            const auto in = makeSignal(kind, numElems, compSize);
+            std::vector<uint8_t> encoded(in.size()*2+64);
+            std::vector<uint8_t> out(in.size());
+
+            const size_t numBytes = codec.encode(in.data(), numElems, encoded.data(), encoded.size());
+            const size_t consumed = codec.decode(encoded.data(), numBytes, out.data(), numElems);
+            if (numBytes == 0 or consumed != numBytes or out != in)
+            {
+                std::printf("FAIL lossless %s %s: numElems=%d encoded=%d consumed=%d\n",
+                    format.c_str(), signalName(kind), int(numElems), int(numBytes), int(consumed));
+                failures++;
+                continue;
+            }
+
+            //the encoder does not write past the maximum size
+            if (codec.encode(in.data(), numElems, encoded.data(), numBytes-1) != 0)
+            {
+                std::printf("FAIL lossless %s %s: numElems=%d encoded into %d bytes\n",
+                    format.c_str(), signalName(kind), int(numElems), int(numBytes-1));
+                failures++;
+            }
+
+            //every truncated input is rejected
+            for (size_t truncated = 0; truncated < numBytes; truncated++)
+            {
+                if (codec.decode(encoded.data(), truncated, out.data(), numElems) == 0) continue;
+                std::printf("FAIL lossless %s %s: numElems=%d decoded %d of %d bytes\n",
+                    format.c_str(), signalName(kind), int(numElems), int(truncated), int(numBytes));
+                failures++;
+                break;
+            }
+
+            //a block width wider than the component is rejected
+            encoded[0] = uint8_t(compSize*8+1);
+            if (codec.decode(encoded.data(), numBytes, out.data(), numElems) != 0)
+            {
+                std::printf("FAIL lossless %s %s: numElems=%d decoded a malformed width\n",
+                    format.c_str(), signalName(kind), int(numElems));
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+/***********************************************************************
+ * Block floating point codecs: the encoded size is fixed
+ * by the number of elements, and short inputs are rejected.
+ **********************************************************************/
+static int testBlockFloatSize(const std::string &codecName, const size_t mantBits)
+{
+    int failures = 0;
+    SoapyStreamCodec codec(codecName, SOAPY_SDR_CS16);
+
+    for (const auto kind : {SIGNAL_ZERO, SIGNAL_TONE, SIGNAL_RANDOM, SIGNAL_EXTREME})
+    {
+        for (const size_t numElems : ELEM_COUNTS)
+        {
+            //one exponent byte per block of 64 components
+            const size_t numComps = numElems*2;
+            const size_t expected = (numComps+63)/64 + numComps*mantBits/8;
+            const auto in = makeSignal(kind, numElems, 2);
+            std::vector<uint8_t> encoded(expected);
+            std::vector<uint8_t> out(in.size());
+
+            const size_t numBytes = codec.encode(in.data(), numElems, encoded.data(), encoded.size());
+            const size_t consumed = codec.decode(encoded.data(), numBytes, out.data(), numElems);
+            if (codec.fixedBytes(numElems) != expected or numBytes != expected or consumed != expected)
+            {
+                std::printf("FAIL %s %s: numElems=%d fixedBytes=%d encoded=%d consumed=%d expected=%d\n",
+                    codecName.c_str(), signalName(kind), int(numElems),
+                    int(codec.fixedBytes(numElems)), int(numBytes), int(consumed), int(expected));
+                failures++;
+                continue;
+            }
+
+            if (codec.encode(in.data(), numElems, encoded.data(), expected-1) != 0 or
+                codec.decode(encoded.data(), expected-1, out.data(), numElems) != 0)
+            {
+                std::printf("FAIL %s %s: numElems=%d accepted a short buffer\n",
+                    codecName.c_str(), signalName(kind), int(numElems));
+                failures++;
+            }
+
+            //an exponent beyond the 16 bit components is rejected
+            encoded[0] = uint8_t(16-mantBits+1);
+            if (codec.decode(encoded.data(), expected, out.data(), numElems) != 0)
+            {
+                std::printf("FAIL %s %s: numElems=%d decoded a malformed exponent\n",
+                    codecName.c_str(), signalName(kind), int(numElems));
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+/***********************************************************************
+ * Block floating point error: a block whose components fit the mantissa
+ * decodes exactly, otherwise the error is under one step of the exponent
+ * (half a step rounded, plus the saturation of the largest mantissa).
+ * At full scale that is 255 for bfp8 and 15 for bfp12.
+ **********************************************************************/
+static int blockExponent(const int16_t *block, const size_t n, const size_t mantBits)
+{
+    int width = 1; //sign bit
+    for (size_t j = 0; j < n; j++)
+    {
+        const int mag = (block[j] < 0)?(-block[j]-1):block[j];
+        while ((mag >> (width-1)) != 0) width++;
+    }
+    return std::max(0, width-int(mantBits));
+}
+
+static int testBlockFloatError(const std::string &codecName, const size_t mantBits)
+{
+    int failures = 0;
+    SoapyStreamCodec codec(codecName, SOAPY_SDR_CS16);
+    const int fullScaleError = (1 << (16-mantBits))-1;
+
+    for (const int amplitude : {0, 1, 7, 100, (1 << (mantBits-1))-1, 1 << (mantBits-1), 1000, 20000, 32767, 32768})
+    {
+        const size_t numElems = 1023;
+        std::vector<int16_t> in(numElems*2), out(numElems*2);
+        std::vector<uint8_t> encoded(codec.fixedBytes(numElems));
+        for (size_t i = 0; i < in.size(); i++)
+        {
+            //random components in [-amplitude, amplitude-1] with both limits present
+            const int value = (amplitude == 0)?0:(rand()%(2*amplitude))-amplitude;
+            in[i] = int16_t(value);
+            if (i%64 == 5) in[i] = int16_t(-amplitude);
+            if (i%64 == 9 and amplitude != 0) in[i] = int16_t(std::min(amplitude, 32767));
+        }
+
+        codec.encode(in.data(), numElems, encoded.data(), encoded.size());
+        codec.decode(encoded.data(), encoded.size(), out.data(), numElems);
+
+        int maxError = 0;
+        for (size_t i = 0; i < in.size(); i += 64)
+        {
+            const size_t n = std::min<size_t>(64, in.size()-i);
+            const int bound = (1 << blockExponent(in.data()+i, n, mantBits))-1;
+            for (size_t j = i; j < i+n; j++)
+            {
+                const int error = std::abs(int(in[j])-int(out[j]));
+                maxError = std::max(maxError, error);
+                if (error <= bound and error <= fullScaleError) continue;
+                std::printf("FAIL %s amplitude=%d: component %d error %d over bound %d\n",
+                    codecName.c_str(), amplitude, int(j), error, bound);
+                failures++;
+                break;
+            }
+        }
+
+        //blocks that fit the mantissa are exact
+        const bool fitsMantissa = amplitude < (1 << (mantBits-1));
+        if (fitsMantissa and maxError != 0)
+        {
+            std::printf("FAIL %s amplitude=%d: small block error %d\n", codecName.c_str(), amplitude, maxError);
+            failures++;
+        }
+    }
+
+    //the component limits reach the full scale error bound and no further
+    const size_t numElems = 32;
+    std::vector<int16_t> in(numElems*2), out(numElems*2);
+    std::vector<uint8_t> encoded(codec.fixedBytes(numElems));
+    for (size_t i = 0; i < in.size(); i++) in[i] = int16_t(32767-int(i)*3);
+    in[1] = -32768;
+    codec.encode(in.data(), numElems, encoded.data(), encoded.size());
+    codec.decode(encoded.data(), encoded.size(), out.data(), numElems);
+    int maxError = 0;
+    for (size_t i = 0; i < in.size(); i++) maxError = std::max(maxError, std::abs(int(in[i])-int(out[i])));
+    if (maxError != fullScaleError or out[1] != -32768)
+    {
+        std::printf("FAIL %s full scale: max error %d expected %d\n", codecName.c_str(), maxError, fullScaleError);
+        failures++;
+    }
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+    failures += testLossless(SOAPY_SDR_CS16, 2);
+    failures += testLossless(SOAPY_SDR_CS8, 1);
+    failures += testLossless(SOAPY_SDR_CU8, 1);
+    failures += testBlockFloatSize("bfp8", 8);
+    failures += testBlockFloatSize("bfp12", 12);
+    failures += testBlockFloatError("bfp8", 8);
+    failures += testBlockFloatError("bfp12", 12);
+    if (failures == 0) std::printf("PASS\n");
+    return (failures == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2020 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+//the kernels are static, test them from inside the translation unit
+#include "SoapyStreamConvert.cpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/***********************************************************************
+ * Compare each instruction set kernel against its generic kernel
+ * for every element count up to 1023, including the tail lengths,
+ * with random inputs mixed with the saturation edge values.
+ **********************************************************************/
+enum InputKind
+{
+    INPUT_INT, //random bytes with integer limits
+    INPUT_FLOAT, //floats around full scale with edge values
+    INPUT_HALF, //half floats around full scale with edge values
+};
+
+struct KernelTest
+{
+    const char *name;
+    const char *isa; //cpu feature for __builtin_cpu_supports
+    ConvertFunction generic;
+    ConvertFunction kernel;
+    size_t inBytes; //bytes per complex element
+    size_t outBytes;
+    InputKind input;
+    size_t compBytes; //integer component size for the limits
+};
+
+static const size_t MAX_ELEMS = 1024;
+static const size_t GUARD_BYTES = 64;
+
+static float edgeFloat(const size_t i, const double scaleFactor)
+{
+    //full scale of the float formats is 1.0, the scale factor maps it onto integers
+    const float lsb = float(1.0/scaleFactor);
+    const float edges[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 1.0f+lsb, -1.0f-lsb, 1.0f-lsb/2, -1.0f+lsb/2,
+        lsb/2, -lsb/2, 3*lsb/2, -3*lsb/2, 1e9f, -1e9f,
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min(),
+    };
+    const size_t numEdges = sizeof(edges)/sizeof(edges[0]);
+    if (i%3 == 0) return edges[(i/3)%numEdges];
+    return (rand()/float(RAND_MAX))*2.5f-1.25f;
+}
+
+static void fillInput(std::vector<uint8_t> &in, const KernelTest &test, const double scaleFactor)
+{
+    for (auto &b : in) b = uint8_t(rand());
+    if (test.input == INPUT_FLOAT)
+    {
+        auto p = (float *)in.data();
+        for (size_t i = 0; i < in.size()/sizeof(float); i++) p[i] = edgeFloat(i, scaleFactor);
+    }
+    if (test.input == INPUT_HALF)
+    {
+        auto p = (uint16_t *)in.data();
+        for (size_t i = 0; i < in.size()/sizeof(uint16_t); i++)
+        {
+            p[i] = floatToHalf(float(edgeFloat(i, scaleFactor)*scaleFactor));
+        }
+    }
+    if (test.input == INPUT_INT and test.compBytes == 2)
+    {
+        auto p = (int16_t *)in.data();
+        for (size_t i = 0; i < in.size()/sizeof(int16_t); i += 5) p[i] = (i%2)?32767:-32768;
+    }
+    if (test.input == INPUT_INT and test.compBytes == 1)
+    {
+        for (size_t i = 0; i < in.size(); i += 5) in[i] = (i%2)?0x7f:0x80;
+        for (size_t i = 2; i < in.size(); i += 7) in[i] = (i%2)?0xff:0x00;
+    }
+}
+
+static bool testKernel(const KernelTest &test)
+{
+    std::vector<uint8_t> in(MAX_ELEMS*test.inBytes);
+    std::vector<uint8_t> outGeneric(MAX_ELEMS*test.outBytes+GUARD_BYTES);
+    std::vector<uint8_t> outKernel(outGeneric.size());
+
+    for (const double scaleFactor : {1.0, 127.0, 128.0, 1000.0, 2048.0, 32767.0, 32768.0})
+    {
+        fillInput(in, test, scaleFactor);
+        for (size_t numElems = 0; numElems < MAX_ELEMS; numElems++)
+        {
+            std::fill(outGeneric.begin(), outGeneric.end(), 0xAA);
+            std::fill(outKernel.begin(), outKernel.end(), 0xAA);
+            test.generic(in.data(), outGeneric.data(), numElems, scaleFactor);
+            test.kernel(in.data(), outKernel.data(), numElems, scaleFactor);
+            if (outGeneric == outKernel) continue;
+
+            size_t i = 0;
+            while (outGeneric[i] == outKernel[i]) i++;
+            std::printf("FAIL %s %s: numElems=%d scaleFactor=%g first difference at byte %d\n",
+                test.name, test.isa, int(numElems), scaleFactor, int(i));
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<KernelTest> kernelTests(void)
+{
+    std::vector<KernelTest> tests;
+    #ifdef CONVERT_HAS_X86
+    tests.push_back({"CS16->CF32", "sse2", CS16toCF32_generic, CS16toCF32_sse2, 4, 8, INPUT_INT, 2});
+    tests.push_back({"CF32->CS16", "sse2", CF32toCS16_generic, CF32toCS16_sse2, 8, 4, INPUT_FLOAT, 0});
+    tests.push_back({"CS8->CS16", "sse2", CS8toCS16_generic, CS8toCS16_sse2, 2, 4, INPUT_INT, 1});
+    tests.push_back({"CS16->CS8", "sse2", CS16toCS8_generic, CS16toCS8_sse2, 4, 2, INPUT_INT, 2});
+    tests.push_back({"CS8->CF32", "sse2", CS8toCF32_generic, CS8toCF32_sse2, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CS8", "sse2", CF32toCS8_generic, CF32toCS8_sse2, 8, 2, INPUT_FLOAT, 0});
+    tests.push_back({"CU8->CF32", "sse2", CU8toCF32_generic, CU8toCF32_sse2, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CU8", "sse2", CF32toCU8_generic, CF32toCU8_sse2, 8, 2, INPUT_FLOAT, 0});
+    tests.push_back({"CS4->CF32", "sse2", CS4toCF32_generic, CS4toCF32_sse2, 1, 8, INPUT_INT, 0});
+    tests.push_back({"CF32->CS4", "sse2", CF32toCS4_generic, CF32toCS4_sse2, 8, 1, INPUT_FLOAT, 0});
+
+    tests.push_back({"CS12->CS16", "ssse3", CS12toCS16_generic, CS12toCS16_ssse3, 3, 4, INPUT_INT, 0});
+    tests.push_back({"CS16->CS12", "ssse3", CS16toCS12_generic, CS16toCS12_ssse3, 4, 3, INPUT_INT, 2});
+    tests.push_back({"CS12->CF32", "ssse3", CS12toCF32_generic, CS12toCF32_ssse3, 3, 8, INPUT_INT, 0});
+    tests.push_back({"CF32->CS12", "ssse3", CF32toCS12_generic, CF32toCS12_ssse3, 8, 3, INPUT_FLOAT, 0});
+
+    tests.push_back({"CS16->CF32", "avx2", CS16toCF32_generic, CS16toCF32_avx2, 4, 8, INPUT_INT, 2});
+    tests.push_back({"CF32->CS16", "avx2", CF32toCS16_generic, CF32toCS16_avx2, 8, 4, INPUT_FLOAT, 0});
+    tests.push_back({"CS8->CS16", "avx2", CS8toCS16_generic, CS8toCS16_avx2, 2, 4, INPUT_INT, 1});
+    tests.push_back({"CS16->CS8", "avx2", CS16toCS8_generic, CS16toCS8_avx2, 4, 2, INPUT_INT, 2});
+    tests.push_back({"CS8->CF32", "avx2", CS8toCF32_generic, CS8toCF32_avx2, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CS8", "avx2", CF32toCS8_generic, CF32toCS8_avx2, 8, 2, INPUT_FLOAT, 0});
+    tests.push_back({"CU8->CF32", "avx2", CU8toCF32_generic, CU8toCF32_avx2, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CU8", "avx2", CF32toCU8_generic, CF32toCU8_avx2, 8, 2, INPUT_FLOAT, 0});
+    tests.push_back({"CS12->CS16", "avx2", CS12toCS16_generic, CS12toCS16_avx2, 3, 4, INPUT_INT, 0});
+    tests.push_back({"CS16->CS12", "avx2", CS16toCS12_generic, CS16toCS12_avx2, 4, 3, INPUT_INT, 2});
+    tests.push_back({"CS12->CF32", "avx2", CS12toCF32_generic, CS12toCF32_avx2, 3, 8, INPUT_INT, 0});
+    tests.push_back({"CF32->CS12", "avx2", CF32toCS12_generic, CF32toCS12_avx2, 8, 3, INPUT_FLOAT, 0});
+
+    tests.push_back({"CS16->CF32", "avx512f", CS16toCF32_generic, CS16toCF32_avx512, 4, 8, INPUT_INT, 2});
+    tests.push_back({"CF32->CS16", "avx512f", CF32toCS16_generic, CF32toCS16_avx512, 8, 4, INPUT_FLOAT, 0});
+    tests.push_back({"CS8->CF32", "avx512f", CS8toCF32_generic, CS8toCF32_avx512, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CS8", "avx512f", CF32toCS8_generic, CF32toCS8_avx512, 8, 2, INPUT_FLOAT, 0});
+    tests.push_back({"CU8->CF32", "avx512f", CU8toCF32_generic, CU8toCF32_avx512, 2, 8, INPUT_INT, 1});
+    tests.push_back({"CF32->CU8", "avx512f", CF32toCU8_generic, CF32toCU8_avx512, 8, 2, INPUT_FLOAT, 0});
+
+    //both directions of the scale, for CF16 as the remote or the local format
+    tests.push_back({"CF16->CF32", "f16c", CF16toCF32_generic, CF16toCF32_f16c<true>, 4, 8, INPUT_HALF, 0});
+    tests.push_back({"CF32->CF16", "f16c", CF32toCF16_generic, CF32toCF16_f16c<false>, 8, 4, INPUT_FLOAT, 0});
+    tests.push_back({"CF32->CF16 local", "f16c", convertSamples<float, HalfSample, true>, CF32toCF16_f16c<true>, 8, 4, INPUT_FLOAT, 0});
+    tests.push_back({"CF16->CF32 local", "f16c", convertSamples<HalfSample, float, false>, CF16toCF32_f16c<false>, 4, 8, INPUT_HALF, 0});
+    #endif //CONVERT_HAS_X86
+    return tests;
+}
+
+static bool isSupported(const std::string &isa)
+{
+    #ifdef CONVERT_HAS_X86
+    __builtin_cpu_init();
+    if (isa == "sse2") return __builtin_cpu_supports("sse2");
+    if (isa == "ssse3") return __builtin_cpu_supports("ssse3");
+    if (isa == "avx2") return __builtin_cpu_supports("avx2");
+    if (isa == "avx512f") return __builtin_cpu_supports("avx512f");
+    if (isa == "f16c") return __builtin_cpu_supports("avx") and __builtin_cpu_supports("f16c");
+    #endif //CONVERT_HAS_X86
+    return false;
+}
+
+int main(void)
+{
+    int failures = 0;
+    for (const auto &test : kernelTests())
+    {
+        if (not isSupported(test.isa))
+        {
+            std::printf("SKIP %s %s: not supported by this cpu\n", test.name, test.isa);
+            continue;
+        }
+        if (testKernel(test)) std::printf("PASS %s %s\n", test.name, test.isa);
+        else failures++;
+    }
+    return (failures == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+}